@@ -485,7 +485,13 @@ void runSpellingBeeGame(const std::vector<WordUtils::Word> &allWordsVec, bool lo
 void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData = false)
 {
     ProfilerUtils::Profiler profiler;
-    std::vector<Wordle::Feedback> feedbackHistory;
+    Wordle::FeedbackMatrix feedbackMatrix = Wordle::loadFeedbackMatrix(allWordsVec);
+    std::map<int, Wordle::OpeningBook> openingBooks; // Loaded per search depth on first use
+
+    Wordle::Config sessionConfig;
+    sessionConfig.feedbackMatrix = &feedbackMatrix;
+    sessionConfig.topK = 20; // Only the best 20 are shown
+    Wordle::Session session(allWordsVec, sessionConfig);
 
     while (true)
     {
@@ -494,10 +500,10 @@ void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData
         std::cout << "Format: WORD 01201 (0=grey, 1=yellow, 2=green)\n";
         std::cout << "Enter 'solve' to get best guesses, 'clear' to start over, 'q' to quit\n\n";
 
-        if (!feedbackHistory.empty())
+        if (!session.history().empty())
         {
             std::cout << "Current feedback history:\n";
-            for (const auto &fb : feedbackHistory)
+            for (const auto &fb : session.history())
             {
                 std::cout << "  " << fb.word << " ";
                 for (int i = 0; i < 5; ++i)
@@ -524,7 +530,7 @@ void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData
 
             if (input == "clear")
             {
-                feedbackHistory.clear();
+                session.clear();
                 std::cout << "Feedback history cleared.\n\n";
                 break;
             }
@@ -558,13 +564,24 @@ void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData
 
                 profiler.start();
 
-                Wordle::Config config;
+                Wordle::Config config = sessionConfig;
                 config.maxDepth = maxDepth;
+                const Wordle::OpeningBook *openingBook = nullptr;
+                if (Wordle::openingBookApplies(session.history(), config))
+                {
+                    // Only the depth 1 opening is worth building on demand, other books are used if already saved
+                    bool build = maxDepth == 1 && session.history().empty();
+                    if (openingBooks.count(maxDepth) == 0 || (build && openingBooks[maxDepth].opening.empty()))
+                        openingBooks[maxDepth] = Wordle::loadOpeningBook(allWordsVec, config, build);
+                    openingBook = &openingBooks[maxDepth];
+                }
 
-                Wordle::Result result =
-                    Wordle::runWordleSolverWithEntropy(allWordsVec, feedbackHistory, config);
+                // Solving the same position again at the same depth returns the last ranking
+                const Wordle::Result &result = session.solve(maxDepth, openingBook);
 
                 profiler.end();
+                profiler.addCount("Transposition cache hits", result.cacheHits);
+                profiler.addCount("Transposition cache misses", result.cacheMisses);
                 if (logData)
                     profiler.logProfilerData();
 
@@ -597,15 +614,18 @@ void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData
                     for (int i = 0; i < displayCount; ++i)
                     {
                         const auto &guess = result.sortedGuesses[i];
-                        std::cout << guess.word.wordString << ",";
+                        std::cout << Wordle::guessWord(allWordsVec, guess).wordString << ",";
 
                         // Display probability
                         std::cout << std::fixed << std::setprecision(4) << guess.probability;
 
-                        // Display all entropy levels
+                        // Display all entropy levels, "-" for those the search didn't reach
                         for (int j = 0; j < config.maxDepth && j < guess.entropyList.size(); j++)
                         {
-                            std::cout << "," << std::fixed << std::setprecision(3) << guess.entropyList[j];
+                            if (j < guess.scoredDepth)
+                                std::cout << "," << std::fixed << std::setprecision(3) << guess.entropyList[j];
+                            else
+                                std::cout << ",-";
                         }
 
                         std::cout << "\n";
@@ -614,21 +634,10 @@ void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData
                     if (result.totalPossibleWords <= 20)
                     {
                         std::cout << "\nAll remaining possibilities:\n";
-                        // Show the first few possibilities (which are the actual possible words when maxDepth=0)
-                        Wordle::Config possibleConfig;
-                        possibleConfig.maxDepth = 0;
-                        Wordle::Result possibleResult =
-                            Wordle::runWordleSolverWithEntropy(allWordsVec, feedbackHistory, possibleConfig);
-
-                        std::vector<std::string> possibleWords;
-                        for (const auto &guess : possibleResult.sortedGuesses)
-                        {
-                            possibleWords.push_back(guess.word.wordString);
-                        }
-                        std::sort(possibleWords.begin(), possibleWords.end());
-                        for (const auto &word : possibleWords)
+                        // The session's candidates are already in alphabetical order
+                        for (const auto &word : session.candidates())
                         {
-                            std::cout << word << " ";
+                            std::cout << word.wordString << " ";
                         }
                         std::cout << "\n";
                     }
@@ -642,7 +651,7 @@ void runWordleGame(const std::vector<WordUtils::Word> &allWordsVec, bool logData
             try
             {
                 Wordle::Feedback fb = Wordle::parseFeedback(input);
-                feedbackHistory.push_back(fb);
+                session.addFeedback(fb);
                 std::cout << "Added: " << fb.word << " ";
                 for (int i = 0; i < 5; ++i)
                 {
@@ -675,7 +684,7 @@ void runMastermindGame(bool logData = false)
         try
         {
             config.numPegs = std::stoi(input);
-            if (config.numPegs < 1 || config.numPegs > 20)
+            if (config.numPegs < 1 || config.numPegs > Mastermind::MAX_PEGS)
             {
                 std::cout << "Invalid number of pegs, using default of 4.\n";
                 config.numPegs = 4;
@@ -694,7 +703,7 @@ void runMastermindGame(bool logData = false)
         try
         {
             config.numColors = std::stoi(input);
-            if (config.numColors < 1 || config.numColors > 20)
+            if (config.numColors < 1 || config.numColors > Mastermind::MAX_COLORS)
             {
                 std::cout << "Invalid number of colors, using default of 6.\n";
                 config.numColors = 6;
@@ -713,8 +722,24 @@ void runMastermindGame(bool logData = false)
         config.allowDuplicates = false;
     }
 
-    // Generate all possible patterns
-    std::vector<Mastermind::Pattern> allPatterns = Mastermind::generateAllPatterns(config);
+    std::cout << "Scoring strategy (entropy/minimax/parts/expected, default entropy): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        try
+        {
+            config.strategy = Mastermind::parseStrategy(WordUtils::trimToLower(input));
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << e.what() << ", using entropy.\n";
+        }
+    }
+
+    // Generate all possible patterns and their feedback table
+    Mastermind::FeedbackTable feedbackTable;
+    std::vector<Mastermind::Pattern> allPatterns = Mastermind::generateAllPatterns(config, &feedbackTable);
+    config.feedbackTable = &feedbackTable;
     std::cout << "Generated " << allPatterns.size() << " possible patterns.\n\n";
 
     while (true)
@@ -779,6 +804,10 @@ void runMastermindGame(bool logData = false)
             Mastermind::Result result = Mastermind::runMastermindSolverWithEntropy(allPatterns, guessHistory, config);
 
             profiler.end();
+            profiler.addCount("Transposition cache hits", result.cacheHits);
+            profiler.addCount("Transposition cache misses", result.cacheMisses);
+            if (logData)
+                profiler.logProfilerData();
 
             if (result.sortedGuesses.empty())
             {
@@ -786,7 +815,8 @@ void runMastermindGame(bool logData = false)
             }
             else
             {
-                std::cout << "\nBest guesses (sorted by information value):\n";
+                bool partitionStrategy = config.strategy != Mastermind::Strategy::Entropy;
+                std::cout << "\nBest guesses (sorted by " << (partitionStrategy ? "partition" : "information value") << "):\n";
 
                 // Create header with entropy columns
                 std::cout << "Pattern\t\t\t";
@@ -794,14 +824,20 @@ void runMastermindGame(bool logData = false)
                 {
                     std::cout << "E" << (i + 1) << "\t";
                 }
-                std::cout << "Probability\n";
+                std::cout << "Probability";
+                if (partitionStrategy)
+                    std::cout << "\tLargest\tParts\tExpected";
+                std::cout << "\n";
 
                 std::cout << "-------\t\t\t";
                 for (int i = 0; i < config.maxDepth; i++)
                 {
                     std::cout << "-------\t";
                 }
-                std::cout << "-----------\n";
+                std::cout << "-----------";
+                if (partitionStrategy)
+                    std::cout << "\t-------\t-----\t--------";
+                std::cout << "\n";
 
                 int displayCount = std::min(20, static_cast<int>(result.sortedGuesses.size()));
                 for (int i = 0; i < displayCount; ++i)
@@ -812,10 +848,19 @@ void runMastermindGame(bool logData = false)
                     // Display probability
                     std::cout << std::fixed << std::setprecision(4) << guess.probability;
 
-                    // Display all entropy levels
+                    // Display all entropy levels, "-" for those the search didn't reach
                     for (int j = 0; j < config.maxDepth && j < guess.entropyList.size(); j++)
                     {
-                        std::cout << "," << std::fixed << std::setprecision(3) << guess.entropyList[j];
+                        if (j < guess.scoredDepth)
+                            std::cout << "," << std::fixed << std::setprecision(3) << guess.entropyList[j];
+                        else
+                            std::cout << ",-";
+                    }
+
+                    if (partitionStrategy)
+                    {
+                        std::cout << "," << guess.largestPart << "," << guess.numParts << ","
+                                  << std::fixed << std::setprecision(3) << guess.expectedSize;
                     }
 
                     std::cout << "\n";
@@ -933,15 +978,30 @@ struct CmdArgs
     int pruneRedundantPaths = -1;
     int pruneDominatedClasses = -1;
     int excludeUncommonWords = -1;
-    int start = 0;                                     // for read mode
-    int end = -1;                                      // for read mode
-    std::string file = "results/temp.txt";             // default file for output/input (legacy)
-    std::string possibleFile = "results/possible.txt"; // file for possible words
-    std::string guessesFile = "results/guesses.txt";   // file for guesses with entropy
+    int threads = 0;                                       // solver threads, 0 = one per hardware thread
+    int pruneTopN = 0;                                     // wordle guesses kept exact past depth 1, 0 = no pruning
+    int timeBudgetMs = 0;                                  // wordle/mastermind search deadline, 0 = none
+    int sampleSize = 0;                                    // wordle targets sampled past depth 1, 0 = exact
+    int sampleAbove = 1000;                                // wordle positions up to this many candidates stay exact
+    int sampleSeed = 1;                                    // wordle target sampling seed
+    std::string objective = "entropy";                     // wordle ranking: entropy or guesses
+    int breadth = 10;                                      // wordle guesses tried per position for --objective guesses
+    int topK = 0;                                          // wordle guesses written, best first, 0 = all
+    int wordLength = 5;                                    // wordle letters per word
+    int hardMode = 0;                                      // wordle guesses must use every revealed hint
+    int boards = 4;                                        // wordle-multi boards played at once
+    int start = 0;                                         // for read mode
+    int end = -1;                                          // for read mode
+    std::string file = "results/temp.txt";                 // default file for output/input (legacy)
+    std::string possibleFile = "results/possible.txt";     // file for possible words
+    std::string guessesFile = "results/guesses.txt";       // file for guesses with entropy
+    std::string strategyFile = "data/wordle_strategy.bin"; // saved wordle strategy tree
     // Mastermind-specific
     int numPegs = 4;             // number of pegs in mastermind
     int numColors = 6;           // number of colors in mastermind
     bool allowDuplicates = true; // allow duplicate colors in mastermind
+    std::string strategy = "entropy"; // mastermind ranking: entropy, minimax, parts or expected
+    bool symmetry = true;             // score one mastermind guess per symmetry class
     bool valid = false;
 };
 
@@ -988,6 +1048,54 @@ CmdArgs parseFlags(int argc, char *argv[])
         {
             args.excludeUncommonWords = std::stoi(argv[++i]);
         }
+        else if (a == "--threads" && i + 1 < argc)
+        {
+            args.threads = std::stoi(argv[++i]);
+        }
+        else if (a == "--pruneTopN" && i + 1 < argc)
+        {
+            args.pruneTopN = std::stoi(argv[++i]);
+        }
+        else if (a == "--timeBudgetMs" && i + 1 < argc)
+        {
+            args.timeBudgetMs = std::stoi(argv[++i]);
+        }
+        else if (a == "--sampleSize" && i + 1 < argc)
+        {
+            args.sampleSize = std::stoi(argv[++i]);
+        }
+        else if (a == "--sampleAbove" && i + 1 < argc)
+        {
+            args.sampleAbove = std::stoi(argv[++i]);
+        }
+        else if (a == "--sampleSeed" && i + 1 < argc)
+        {
+            args.sampleSeed = std::stoi(argv[++i]);
+        }
+        else if (a == "--objective" && i + 1 < argc)
+        {
+            args.objective = argv[++i];
+        }
+        else if (a == "--breadth" && i + 1 < argc)
+        {
+            args.breadth = std::stoi(argv[++i]);
+        }
+        else if (a == "--topK" && i + 1 < argc)
+        {
+            args.topK = std::stoi(argv[++i]);
+        }
+        else if (a == "--wordLength" && i + 1 < argc)
+        {
+            args.wordLength = std::stoi(argv[++i]);
+        }
+        else if (a == "--hardMode" && i + 1 < argc)
+        {
+            args.hardMode = std::stoi(argv[++i]);
+        }
+        else if (a == "--boards" && i + 1 < argc)
+        {
+            args.boards = std::stoi(argv[++i]);
+        }
         else if (a == "--start" && i + 1 < argc)
         {
             args.start = std::stoi(argv[++i]);
@@ -1008,6 +1116,10 @@ CmdArgs parseFlags(int argc, char *argv[])
         {
             args.guessesFile = argv[++i];
         }
+        else if (a == "--strategyFile" && i + 1 < argc)
+        {
+            args.strategyFile = argv[++i];
+        }
         else if (a == "--numPegs" && i + 1 < argc)
         {
             args.numPegs = std::stoi(argv[++i]);
@@ -1020,6 +1132,14 @@ CmdArgs parseFlags(int argc, char *argv[])
         {
             args.allowDuplicates = (std::stoi(argv[++i]) != 0);
         }
+        else if (a == "--strategy" && i + 1 < argc)
+        {
+            args.strategy = argv[++i];
+        }
+        else if (a == "--symmetry" && i + 1 < argc)
+        {
+            args.symmetry = (std::stoi(argv[++i]) != 0);
+        }
     }
     args.valid = true;
     if (args.mode.empty() && args.letters.empty())
@@ -1032,6 +1152,39 @@ CmdArgs parseFlags(int argc, char *argv[])
         std::cout << "Invalid argument combination.\n";
         args.valid = false;
     }
+    if (args.mode.rfind("wordle", 0) == 0 && (args.wordLength < Wordle::MIN_WORD_LENGTH || args.wordLength > Wordle::MAX_WORD_LENGTH))
+    {
+        std::cout << "Word length must be " << Wordle::MIN_WORD_LENGTH << " to " << Wordle::MAX_WORD_LENGTH << ".\n";
+        args.valid = false;
+    }
+    if (args.mode.rfind("wordle", 0) == 0 && args.maxDepth > Wordle::MAX_SEARCH_DEPTH)
+    {
+        std::cout << "Wordle search depth must be at most " << Wordle::MAX_SEARCH_DEPTH << ".\n";
+        args.valid = false;
+    }
+    if (args.mode == "mastermind" && (args.numPegs < 1 || args.numPegs > Mastermind::MAX_PEGS ||
+                                      args.numColors < 1 || args.numColors > Mastermind::MAX_COLORS))
+    {
+        std::cout << "Mastermind supports 1 to " << Mastermind::MAX_PEGS << " pegs of 1 to " << Mastermind::MAX_COLORS << " colors.\n";
+        args.valid = false;
+    }
+    if (args.mode == "mastermind")
+    {
+        try
+        {
+            Mastermind::parseStrategy(args.strategy);
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << e.what() << ".\n";
+            args.valid = false;
+        }
+    }
+    if (args.mode == "wordle-multi" && args.boards < 1)
+    {
+        std::cout << "At least one board is required.\n";
+        args.valid = false;
+    }
     if (args.mode == "read" && (args.start < 0 || args.end < args.start))
     {
         std::cout << "Invalid read range.\n";
@@ -1048,14 +1201,18 @@ int main(int argc, char *argv[])
 
     CmdArgs cmd = parseFlags(argc, argv);
 
-    // Print usage if argument is "help"
-    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "help" || std::string(argv[1]) == "-h" || !cmd.valid))
+    // Print usage if argument is "help", or after invalid arguments
+    bool helpRequested = argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "help" || std::string(argv[1]) == "-h");
+    if (argc > 1 && (helpRequested || !cmd.valid))
     {
         std::cout << "Usage:\n";
         std::cout << "  --mode <mode>: Specify the mode of operation. Options are:\n";
         std::cout << "      letterboxed: Solve the Letter Boxed puzzle.\n";
         std::cout << "      spellingbee: Solve the Spelling Bee puzzle.\n";
         std::cout << "      wordle: Solve Wordle puzzles with entropy-based suggestions.\n";
+        std::cout << "      wordle-tree: Look up the next Wordle guess in a saved strategy tree.\n";
+        std::cout << "      wordle-bench: Play the Wordle solver against every possible answer and report its performance.\n";
+        std::cout << "      wordle-multi: Solve several Wordle boards played with the same guesses (Quordle, Octordle).\n";
         std::cout << "      mastermind: Solve Mastermind puzzles with entropy-based suggestions.\n";
         std::cout << "      read: Read and display results from a file.\n";
         std::cout << "\n";
@@ -1079,7 +1236,7 @@ int main(int argc, char *argv[])
         std::cout << "\n";
 
         std::cout << "  Wordle:\n";
-        std::cout << "    " << argv[0] << " --mode wordle --guesses \"STEAL 01201\" \"CRANE 00120\" [--maxDepth <depth>] [--possibleFile <filename>] [--guessesFile <filename>] [--excludeUncommonWords <0|1>]\n";
+        std::cout << "    " << argv[0] << " --mode wordle --guesses \"STEAL 01201\" \"CRANE 00120\" [--maxDepth <depth>] [--possibleFile <filename>] [--guessesFile <filename>] [--excludeUncommonWords <0|1>] [--threads <num>] [--pruneTopN <num>] [--timeBudgetMs <ms>] [--sampleSize <num>] [--sampleAbove <num>] [--sampleSeed <num>] [--objective <entropy|guesses>] [--breadth <num>] [--topK <num>] [--wordLength <4-8>] [--hardMode <0|1>]\n";
         std::cout << "      --guesses: Specify guess/feedback pairs. Format: \"WORD 01201\" where:\n";
         std::cout << "                 0=grey (letter not in word), 1=yellow (letter in word, wrong position),\n";
         std::cout << "                 2=green (letter in word, correct position)\n";
@@ -1087,10 +1244,51 @@ int main(int argc, char *argv[])
         std::cout << "      --possibleFile: Output file for possible solution words (default: results/possible.txt).\n";
         std::cout << "      --guessesFile: Output file for all guesses with entropy/probability (default: results/guesses.txt).\n";
         std::cout << "      --excludeUncommonWords: 0 or 1 to enable/disable excluding uncommon words (default: 0).\n";
+        std::cout << "      --threads: Number of solver threads (default: 0 = one per CPU core).\n";
+        std::cout << "      --pruneTopN: Guesses scored exactly past depth 1, the rest are ranked by depth 1 only (default: 0 = score all).\n";
+        std::cout << "      --timeBudgetMs: Return the best ranking found within this time, deepening the most promising guesses first (default: 0 = no limit).\n";
+        std::cout << "                      With a time budget or pruning, each guess row ends with the depth it was scored to.\n";
+        std::cout << "                      Depth 1 is always completed; deeper levels a guess didn't reach in time are written as 0.\n";
+        std::cout << "      --sampleSize: Estimate levels past depth 1 from this many sampled targets (default: 0 = exact).\n";
+        std::cout << "                    The guesses file then also lists the 95% confidence half-width of each level.\n";
+        std::cout << "      --sampleAbove: Positions with at most this many candidates are always scored exactly (default: 1000).\n";
+        std::cout << "      --sampleSeed: Seed of the target samples, runs with the same seed give the same ranking (default: 1).\n";
+        std::cout << "      --objective: Rank by entropy, or by the expected number of guesses to solve with \"guesses\" (default: entropy).\n";
+        std::cout << "                   With \"guesses\" the guesses file also lists the expected guesses, this one included.\n";
+        std::cout << "      --breadth: Guesses tried at each position for --objective guesses (default: 10, 0 = all, exact but slow).\n";
+        std::cout << "      --topK: Only select and write the best this many guesses (default: 0 = all).\n";
+        std::cout << "      --wordLength: Letters per word, 4 to 8 (default: 5). Other lengths than 5 are ranked by entropy only,\n";
+        std::cout << "                    without the feedback matrix, opening book, pruning, time budget or sampling.\n";
+        std::cout << "      --hardMode: 0 or 1, every guess must keep the greens in place and use the yellows (default: 0).\n";
+        std::cout << "\n";
+
+        std::cout << "  Wordle Multi-Board:\n";
+        std::cout << "    " << argv[0] << " --mode wordle-multi --boards 4 --guesses \"STEAL 01201 00000 22222 10000\" ... [--possibleFile <filename>] [--guessesFile <filename>] [--excludeUncommonWords <0|1>] [--threads <num>] [--topK <num>] [--wordLength <4-8>] [--hardMode <0|1>]\n";
+        std::cout << "      --boards: Number of boards played at once (default: 4).\n";
+        std::cout << "      --guesses: Each guess followed by its feedback on every board, in board order.\n";
+        std::cout << "      Guesses are ranked by their entropy summed over the unsolved boards, a board drops out once solved.\n";
+        std::cout << "      The possible file lists each board's words on one line, the guesses file lists word, expected boards solved and entropy.\n";
+        std::cout << "      Prints the possible word count of each board, the number of guesses and both files.\n";
+        std::cout << "\n";
+
+        std::cout << "  Wordle Strategy Tree:\n";
+        std::cout << "    " << argv[0] << " --mode wordle-tree [--guesses \"STEAL 01201\" ...] [--maxDepth <depth>] [--excludeUncommonWords <0|1>] [--threads <num>] [--hardMode <0|1>] [--strategyFile <filename>]\n";
+        std::cout << "      Builds the full strategy tree from the empty board on first use, and again when the word list or options change.\n";
+        std::cout << "      --guesses: History to replay, the guesses must follow the tree (otherwise the solver is run instead).\n";
+        std::cout << "      --strategyFile: Saved strategy tree (default: data/wordle_strategy.bin).\n";
+        std::cout << "      Prints the next guess, the number of possible words and the strategy file.\n";
+        std::cout << "\n";
+
+        std::cout << "  Wordle Benchmark:\n";
+        std::cout << "    " << argv[0] << " --mode wordle-bench [--maxDepth <depth>] [--excludeUncommonWords <0|1>] [--threads <num>] [--pruneTopN <num>] [--timeBudgetMs <ms>] [--sampleSize <num>] [--sampleAbove <num>] [--sampleSeed <num>] [--objective <entropy|guesses>] [--breadth <num>] [--wordLength <4-8>] [--hardMode <0|1>] [--start <index>] [--end <index>]\n";
+        std::cout << "      Plays one game per answer, always guessing the top ranked word, with games spread over the threads.\n";
+        std::cout << "      --start/--end: Range of answers to play (default: all).\n";
+        std::cout << "      Prints the guess count histogram, mean guesses, failures past 6 guesses, the opening solve time\n";
+        std::cout << "      and the latency of every other position the games reach, each solved once on one thread.\n";
         std::cout << "\n";
 
         std::cout << "  Mastermind:\n";
-        std::cout << "    " << argv[0] << " --mode mastermind --guesses \"1 2 3 4|2 2\" [--numPegs <pegs>] [--numColors <colors>] [--allowDuplicates <0|1>] [--maxDepth <depth>] [--possibleFile <filename>] [--guessesFile <filename>]\n";
+        std::cout << "    " << argv[0] << " --mode mastermind --guesses \"1 2 3 4|2 2\" [--numPegs <pegs>] [--numColors <colors>] [--allowDuplicates <0|1>] [--maxDepth <depth>] [--possibleFile <filename>] [--guessesFile <filename>] [--timeBudgetMs <ms>] [--threads <num>] [--strategy <entropy|minimax|parts|expected>] [--symmetry <0|1>]\n";
         std::cout << "      --guesses: Specify guess/feedback pairs. Format: \"1 2 3 4|2 2\" where:\n";
         std::cout << "                 Pattern: sequence of color numbers separated by spaces\n";
         std::cout << "                 Feedback: <correct_position> <correct_color> (e.g., \"2 2\" = 2 correct position, 2 correct color)\n";
@@ -1100,6 +1298,15 @@ int main(int argc, char *argv[])
         std::cout << "      --maxDepth: Search depth for entropy calculation (1-3, default: 1)\n";
         std::cout << "      --possibleFile: Output file for possible solution patterns (default: results/possible.txt)\n";
         std::cout << "      --guessesFile: Output file for all guesses with entropy/probability (default: results/guesses.txt)\n";
+        std::cout << "      --timeBudgetMs: Return the best ranking found within this time, as in wordle mode (default: 0 = no limit).\n";
+        std::cout << "                      Each guess row then ends with the depth it was scored to.\n";
+        std::cout << "      --threads: Number of solver threads (default: 0 = one per CPU core).\n";
+        std::cout << "      --strategy: Rank by entropy, by the smallest worst-case partition (minimax), by the most partitions (parts)\n";
+        std::cout << "                  or by the smallest expected partition (expected) (default: entropy).\n";
+        std::cout << "                  Other strategies than entropy add the largest partition, partition count and expected size\n";
+        std::cout << "                  to the guesses file.\n";
+        std::cout << "      --symmetry: 0 or 1, score only one guess of those the color and peg relabelings keeping the\n";
+        std::cout << "                  feedback history unchanged map onto each other (default: 1).\n";
         std::cout << "\n";
 
         std::cout << "  Read Mode:\n";
@@ -1112,7 +1319,7 @@ int main(int argc, char *argv[])
         std::cout << "  Help:\n";
         std::cout << "    " << argv[0] << " --help\n";
         std::cout << "      Displays this help message with detailed information about arguments and options.\n";
-        return 0;
+        return helpRequested ? 0 : 1;
     }
 
     if (cmd.valid)
@@ -1297,15 +1504,42 @@ int main(int argc, char *argv[])
             }
 
             ProfilerUtils::Profiler profiler;
+            Wordle::FeedbackMatrix feedbackMatrix = Wordle::loadFeedbackMatrix(allWordsVec);
+
             // Get possible words and best guesses with entropy
             Wordle::Config config;
             config.maxDepth = (cmd.maxDepth != -1) ? cmd.maxDepth : 1; // Use command line depth or default to 1
             config.excludeUncommonWords = (cmd.excludeUncommonWords == 1) ? true : false;
+            config.feedbackMatrix = &feedbackMatrix;
+            config.numThreads = cmd.threads;
+            config.pruneTopN = cmd.pruneTopN;
+            config.timeBudgetMs = cmd.timeBudgetMs;
+            config.sampleSize = cmd.sampleSize;
+            config.sampleAbove = cmd.sampleAbove;
+            config.sampleSeed = cmd.sampleSeed;
+            config.minimizeGuesses = (cmd.objective == "guesses");
+            config.guessBreadth = cmd.breadth;
+            config.wordLength = cmd.wordLength;
+            config.topK = cmd.topK;
+            config.hardMode = (cmd.hardMode == 1);
+
+            // The first two turns are answered from the opening book. It is built on first use for the opening
+            // at depth 1 without a time budget; deeper books take too long to build on demand, and a reply is
+            // already quick to solve, so they are only used if saved.
+            Wordle::OpeningBook openingBook;
+            if (Wordle::openingBookApplies(feedbacks, config))
+            {
+                bool build = feedbacks.empty() && config.maxDepth == 1 && config.timeBudgetMs == 0;
+                openingBook = Wordle::loadOpeningBook(allWordsVec, config, build);
+                config.openingBook = &openingBook;
+            }
 
             profiler.start();
             Wordle::Result result =
                 Wordle::runWordleSolverWithEntropy(allWordsVec, feedbacks, config);
             profiler.end();
+            profiler.addCount("Transposition cache hits", result.cacheHits);
+            profiler.addCount("Transposition cache misses", result.cacheMisses);
             profiler.logProfilerData();
 
             // Use the specific file arguments
@@ -1315,12 +1549,9 @@ int main(int argc, char *argv[])
             // Write possible words to first file (sorted alphabetically)
             std::ofstream possibleFile(possibleWordsFile);
             std::vector<std::string> possibleWords;
-            for (const auto &guess : result.sortedGuesses)
+            for (const auto &word : result.possibleWords)
             {
-                if (guess.probability > 0)
-                {
-                    possibleWords.push_back(guess.word.wordString);
-                }
+                possibleWords.push_back(word.wordString);
             }
             std::sort(possibleWords.begin(), possibleWords.end());
             for (const auto &word : possibleWords)
@@ -1333,7 +1564,7 @@ int main(int argc, char *argv[])
             std::ofstream guessFile(guessesFile);
             for (const auto &guess : result.sortedGuesses)
             {
-                guessFile << guess.word.wordString << ",";
+                guessFile << Wordle::guessWord(allWordsVec, guess).wordString << ",";
                 guessFile << std::fixed << std::setprecision(4) << guess.probability;
 
                 // Write all entropy levels
@@ -1342,6 +1573,23 @@ int main(int argc, char *argv[])
                     guessFile << "," << std::fixed << std::setprecision(3) << guess.entropyList[j];
                 }
 
+                // With sampling, the confidence half-width of each level follows, 0 where it is exact
+                if (config.sampleSize > 0)
+                {
+                    for (size_t j = 0; j < static_cast<size_t>(config.maxDepth) && j < guess.entropyList.size(); j++)
+                    {
+                        double margin = (j < guess.confidenceList.size()) ? guess.confidenceList[j] : 0.0;
+                        guessFile << "," << std::fixed << std::setprecision(3) << margin;
+                    }
+                }
+
+                if (config.minimizeGuesses)
+                    guessFile << "," << std::fixed << std::setprecision(4) << guess.expectedGuesses;
+
+                // A time budget or pruning can leave deeper levels unscored, at 0; the depth scored ends the row
+                if (config.timeBudgetMs > 0 || (config.pruneTopN > 0 && config.maxDepth > 1))
+                    guessFile << "," << guess.scoredDepth;
+
                 guessFile << "\n";
             }
             guessFile.close();
@@ -1353,6 +1601,196 @@ int main(int argc, char *argv[])
             std::cout << guessesFile << "\n";
             return 0;
         }
+        else if (cmd.mode == "wordle-multi")
+        {
+            // Example usage:
+            // --mode wordle-multi --boards 2 --guesses "STEAL 01201 00000" "CRANE 00120 22222" ...
+            std::vector<std::vector<Wordle::Feedback>> boardFeedbacks(cmd.boards);
+            for (int i = 1; i < argc; ++i)
+            {
+                if (std::string(argv[i]) == "--guesses")
+                {
+                    for (int j = i + 1; j < argc && argv[j][0] != '-'; ++j)
+                    {
+                        std::istringstream iss(argv[j]);
+                        std::string word;
+                        std::vector<std::string> colors;
+                        iss >> word;
+                        for (std::string c; iss >> c;)
+                        {
+                            colors.push_back(c);
+                        }
+                        if (colors.size() != boardFeedbacks.size())
+                            throw std::runtime_error("Expected feedback for " + std::to_string(boardFeedbacks.size()) + " boards in \"" + argv[j] + "\"");
+                        for (size_t b = 0; b < colors.size(); ++b)
+                        {
+                            boardFeedbacks[b].push_back(Wordle::parseFeedback(word + " " + colors[b]));
+                        }
+                    }
+                }
+            }
+
+            ProfilerUtils::Profiler profiler;
+            Wordle::FeedbackMatrix feedbackMatrix = Wordle::loadFeedbackMatrix(allWordsVec);
+
+            Wordle::Config config;
+            config.excludeUncommonWords = (cmd.excludeUncommonWords == 1) ? true : false;
+            config.feedbackMatrix = &feedbackMatrix;
+            config.numThreads = cmd.threads;
+            config.topK = cmd.topK;
+            config.wordLength = cmd.wordLength;
+            config.hardMode = (cmd.hardMode == 1);
+
+            profiler.start();
+            Wordle::MultiBoardResult result = Wordle::runMultiBoardSolver(allWordsVec, boardFeedbacks, config);
+            profiler.end();
+            profiler.logProfilerData();
+
+            // One line of possible words per board, sorted alphabetically
+            std::ofstream possibleFile(cmd.possibleFile);
+            for (size_t b = 0; b < result.possibleWords.size(); ++b)
+            {
+                if (result.solved[b])
+                {
+                    possibleFile << "solved\n";
+                    continue;
+                }
+                std::vector<std::string> possibleWords;
+                for (const auto &word : result.possibleWords[b])
+                {
+                    possibleWords.push_back(word.wordString);
+                }
+                std::sort(possibleWords.begin(), possibleWords.end());
+                for (size_t k = 0; k < possibleWords.size(); ++k)
+                {
+                    possibleFile << (k > 0 ? " " : "") << possibleWords[k];
+                }
+                possibleFile << "\n";
+            }
+            possibleFile.close();
+
+            std::ofstream guessFile(cmd.guessesFile);
+            for (const auto &guess : result.sortedGuesses)
+            {
+                guessFile << Wordle::guessWord(allWordsVec, guess).wordString << ",";
+                guessFile << std::fixed << std::setprecision(4) << guess.probability;
+                guessFile << "," << std::fixed << std::setprecision(3) << guess.entropy << "\n";
+            }
+            guessFile.close();
+
+            // Display summary to console
+            for (size_t b = 0; b < result.possibleWords.size(); ++b)
+            {
+                std::cout << (b > 0 ? " " : "") << (result.solved[b] ? 0 : result.possibleWords[b].size());
+            }
+            std::cout << "\n";
+            std::cout << result.sortedGuesses.size() << "\n";
+            std::cout << cmd.possibleFile << "\n";
+            std::cout << cmd.guessesFile << "\n";
+            return 0;
+        }
+        else if (cmd.mode == "wordle-tree")
+        {
+            // Example usage:
+            // --mode wordle-tree --guesses "TARES 00120" ...
+            std::vector<Wordle::Feedback> feedbacks;
+            for (int i = 1; i < argc; ++i)
+            {
+                if (std::string(argv[i]) == "--guesses")
+                {
+                    for (int j = i + 1; j < argc && argv[j][0] != '-'; ++j)
+                    {
+                        feedbacks.push_back(Wordle::parseFeedback(argv[j]));
+                    }
+                }
+            }
+
+            ProfilerUtils::Profiler profiler;
+            Wordle::FeedbackMatrix feedbackMatrix = Wordle::loadFeedbackMatrix(allWordsVec);
+
+            Wordle::Config config;
+            config.maxDepth = (cmd.maxDepth != -1) ? cmd.maxDepth : 1;
+            config.excludeUncommonWords = (cmd.excludeUncommonWords == 1) ? true : false;
+            config.feedbackMatrix = &feedbackMatrix;
+            config.numThreads = cmd.threads;
+            config.hardMode = (cmd.hardMode == 1);
+
+            profiler.start();
+            Wordle::StrategyTree tree = Wordle::loadOrBuildStrategyTree(allWordsVec, {}, config, cmd.strategyFile);
+            std::string nextGuess;
+            int possibleWords = 0;
+            int node = tree.find(feedbacks);
+            if (node >= 0)
+            {
+                nextGuess = tree.guess(node);
+                possibleWords = tree.nodes[node].candidates;
+            }
+            else
+            {
+                // Off the tree, fall back to a regular solve
+                Wordle::Result result = Wordle::runWordleSolverWithEntropy(allWordsVec, feedbacks, config);
+                if (!result.sortedGuesses.empty() && result.totalPossibleWords > 0)
+                    nextGuess = Wordle::guessWord(allWordsVec, result.sortedGuesses[0]).wordString;
+                possibleWords = result.totalPossibleWords;
+            }
+            profiler.end();
+            profiler.logProfilerData();
+
+            std::cout << nextGuess << "\n";
+            std::cout << possibleWords << "\n";
+            std::cout << cmd.strategyFile << "\n";
+            return 0;
+        }
+        else if (cmd.mode == "wordle-bench")
+        {
+            // Example usage:
+            // --mode wordle-bench --maxDepth 1 --excludeUncommonWords 1
+            ProfilerUtils::Profiler profiler;
+            Wordle::FeedbackMatrix feedbackMatrix = Wordle::loadFeedbackMatrix(allWordsVec);
+
+            Wordle::Config config;
+            config.maxDepth = (cmd.maxDepth != -1) ? cmd.maxDepth : 1;
+            config.excludeUncommonWords = (cmd.excludeUncommonWords == 1) ? true : false;
+            config.feedbackMatrix = &feedbackMatrix;
+            config.numThreads = cmd.threads;
+            config.pruneTopN = cmd.pruneTopN;
+            config.timeBudgetMs = cmd.timeBudgetMs;
+            config.sampleSize = cmd.sampleSize;
+            config.sampleAbove = cmd.sampleAbove;
+            config.sampleSeed = cmd.sampleSeed;
+            config.minimizeGuesses = (cmd.objective == "guesses");
+            config.guessBreadth = cmd.breadth;
+            config.wordLength = cmd.wordLength;
+            config.hardMode = (cmd.hardMode == 1);
+
+            std::vector<WordUtils::Word> answers = Wordle::availableWordsFor(allWordsVec, config);
+            size_t first = std::min(static_cast<size_t>(std::max(cmd.start, 0)), answers.size());
+            size_t last = (cmd.end < 0) ? answers.size() : std::min(static_cast<size_t>(cmd.end), answers.size());
+            answers = std::vector<WordUtils::Word>(answers.begin() + first, answers.begin() + std::max(first, last));
+
+            profiler.start();
+            Wordle::BenchmarkResult bench = Wordle::runWordleBenchmark(allWordsVec, answers, config);
+            profiler.end();
+            profiler.logProfilerData();
+
+            std::cout << "Games: " << bench.games << "\n";
+            for (size_t k = 1; k < bench.guessCounts.size(); ++k)
+            {
+                if (bench.guessCounts[k] > 0)
+                    std::cout << "  " << k << " guesses: " << bench.guessCounts[k] << "\n";
+            }
+            if (bench.unsolved > 0)
+                std::cout << "  Unsolved: " << bench.unsolved << "\n";
+            std::cout << "Mean guesses: " << std::fixed << std::setprecision(4) << bench.meanGuesses << "\n";
+            std::cout << "Failures (more than 6 guesses): " << bench.failures(6) << "\n";
+            std::cout << "Opening solve (ms): " << std::setprecision(2) << bench.openingMs << "\n";
+            std::cout << "Positions solved: " << bench.positionLatencyMs.size() << "\n";
+            std::cout << "Position latency (ms): p50 " << bench.latencyPercentile(50)
+                      << ", p90 " << bench.latencyPercentile(90)
+                      << ", p99 " << bench.latencyPercentile(99)
+                      << ", max " << bench.latencyPercentile(100) << "\n";
+            return 0;
+        }
         else if (cmd.mode == "mastermind")
         {
             // Parse mastermind feedback guesses
@@ -1375,14 +1813,22 @@ int main(int argc, char *argv[])
             config.numColors = cmd.numColors;
             config.allowDuplicates = cmd.allowDuplicates;
             config.maxDepth = (cmd.maxDepth != -1) ? cmd.maxDepth : 0;
+            config.timeBudgetMs = cmd.timeBudgetMs;
+            config.numThreads = cmd.threads;
+            config.strategy = Mastermind::parseStrategy(cmd.strategy);
+            config.useSymmetry = cmd.symmetry;
 
-            // Generate all possible patterns
-            std::vector<Mastermind::Pattern> allPatterns = Mastermind::generateAllPatterns(config);
+            // Generate all possible patterns and their feedback table
+            Mastermind::FeedbackTable feedbackTable;
+            std::vector<Mastermind::Pattern> allPatterns = Mastermind::generateAllPatterns(config, &feedbackTable);
+            config.feedbackTable = &feedbackTable;
 
             profiler.start();
             Mastermind::Result result =
                 Mastermind::runMastermindSolverWithEntropy(allPatterns, feedbacks, config);
             profiler.end();
+            profiler.addCount("Transposition cache hits", result.cacheHits);
+            profiler.addCount("Transposition cache misses", result.cacheMisses);
             profiler.logProfilerData();
 
             // Use the specific file arguments
@@ -1397,11 +1843,11 @@ int main(int argc, char *argv[])
                 if (guess.probability > 0)
                 {
                     std::string patternStr;
-                    for (uint8_t color : guess.pattern.colors)
+                    for (int i = 0; i < guess.pattern.size(); ++i)
                     {
                         if (!patternStr.empty())
                             patternStr += " ";
-                        patternStr += std::to_string((int)color);
+                        patternStr += std::to_string((int)guess.pattern.color(i));
                     }
                     possiblePatterns.push_back(patternStr);
                 }
@@ -1417,9 +1863,9 @@ int main(int argc, char *argv[])
             std::ofstream guessFile(guessesFile);
             for (const auto &guess : result.sortedGuesses)
             {
-                for (uint8_t color : guess.pattern.colors)
+                for (int i = 0; i < guess.pattern.size(); ++i)
                 {
-                    guessFile << (int)color << " ";
+                    guessFile << (int)guess.pattern.color(i) << " ";
                 }
                 guessFile << ",";
                 guessFile << std::fixed << std::setprecision(4) << guess.probability;
@@ -1430,6 +1876,17 @@ int main(int argc, char *argv[])
                     guessFile << "," << std::fixed << std::setprecision(3) << guess.entropyList[j];
                 }
 
+                // And the partition the other strategies rank by
+                if (config.strategy != Mastermind::Strategy::Entropy)
+                {
+                    guessFile << "," << guess.largestPart << "," << guess.numParts << ","
+                              << std::fixed << std::setprecision(3) << guess.expectedSize;
+                }
+
+                // A time budget can leave deeper levels unscored, at 0; the depth scored ends the row
+                if (config.timeBudgetMs > 0)
+                    guessFile << "," << guess.scoredDepth;
+
                 guessFile << "\n";
             }
             guessFile.close();
@@ -2,6 +2,7 @@
 #include <vector>
 #include <array>
 #include <algorithm>
+#include <bit>
 #include <iostream>
 #include <cctype>
 #include <cmath>
@@ -9,7 +10,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
-#include <sstream>
+#include <numeric>
+#include <optional>
 #include <sstream>
 #include "utils.hpp"
 #include "mastermind.hpp"
@@ -30,8 +32,7 @@ namespace Mastermind
 
         // Parse guess pattern
         std::istringstream patternIss(patternStr);
-        Pattern guess;
-        guess.colors.clear();
+        std::vector<uint8_t> colors;
         std::string token;
         while (patternIss >> token)
         {
@@ -39,13 +40,14 @@ namespace Mastermind
             {
                 throw std::runtime_error("Pattern must contain only single digit numbers");
             }
-            guess.colors.push_back(token[0] - '0');
+            colors.push_back(token[0] - '0');
         }
 
-        if (guess.colors.size() != numPegs)
+        if (colors.size() != numPegs || numPegs > MAX_PEGS)
         {
             throw std::runtime_error("Pattern must have exactly " + std::to_string(numPegs) + " colors");
         }
+        Pattern guess(colors);
 
         // Parse feedback
         std::istringstream feedbackIss(feedbackStr);
@@ -67,49 +69,115 @@ namespace Mastermind
         return fb;
     }
 
-    // Helper: Check if a pattern matches feedback constraints
-    bool matchesFeedback(const Pattern &candidate, const Feedback &fb)
+    Strategy parseStrategy(const std::string &name)
     {
-        const Pattern &guess = fb.guess;
-        if (candidate.colors.size() != guess.colors.size())
-            return false;
+        if (name == "entropy")
+            return Strategy::Entropy;
+        if (name == "minimax")
+            return Strategy::Minimax;
+        if (name == "parts")
+            return Strategy::MostParts;
+        if (name == "expected")
+            return Strategy::ExpectedSize;
+        throw std::runtime_error("Unknown strategy '" + name + "', expected entropy, minimax, parts or expected");
+    }
 
-        // Count color occurrences in candidate
-        std::map<uint8_t, int> candidateCount;
-        for (uint8_t color : candidate.colors)
+    void sortGuesses(std::vector<PatternGuess> &guesses, Strategy strategy)
+    {
+        if (strategy == Strategy::Entropy)
         {
-            candidateCount[color]++;
+            std::sort(guesses.begin(), guesses.end());
+            return;
         }
 
-        // Count correct positions and adjust counts
-        int correctPositions = 0;
-        for (size_t i = 0; i < candidate.colors.size(); ++i)
+        auto key = [strategy](const PatternGuess &g)
         {
-            if (candidate.colors[i] == guess.colors[i])
+            switch (strategy)
             {
-                correctPositions++;
-                candidateCount[candidate.colors[i]]--;
+            case Strategy::Minimax:
+                return static_cast<double>(g.largestPart);
+            case Strategy::MostParts:
+                return -static_cast<double>(g.numParts);
+            default:
+                return g.expectedSize;
             }
-        }
+        };
+        std::sort(guesses.begin(), guesses.end(), [&key](const PatternGuess &a, const PatternGuess &b)
+                  {
+            double keyA = key(a);
+            double keyB = key(b);
+            if (std::abs(keyA - keyB) > 1e-9)
+                return keyA < keyB;
+            if ((a.probability > 0) != (b.probability > 0))
+                return a.probability > 0;
+            return a < b; });
+    }
 
-        if (correctPositions != fb.correctPosition)
-            return false;
+    // Pegs of the same color in the same position: the nibbles of a XOR b that are zero
+    int exactMatches(const Pattern &a, const Pattern &b)
+    {
+        uint64_t diff = a.pegs ^ b.pegs;
+        uint64_t nonZero = (diff | (diff >> 1) | (diff >> 2) | (diff >> 3)) & 0x1111111111111111ULL;
+        return a.numPegs - std::popcount(nonZero);
+    }
+
+    // Pegs of each color in a pattern
+    using ColorCounts = std::array<uint8_t, MAX_COLORS>;
 
-        // Count correct colors in wrong positions
-        int correctColors = 0;
-        for (size_t i = 0; i < guess.colors.size(); ++i)
+    ColorCounts colorCounts(const Pattern &pattern)
+    {
+        ColorCounts counts{};
+        for (int i = 0; i < pattern.size(); ++i)
         {
-            // Skip positions that were already correct
-            if (candidate.colors[i] == guess.colors[i])
-                continue;
+            counts[pattern.color(i)]++;
+        }
+        return counts;
+    }
 
-            if (candidateCount[guess.colors[i]] > 0)
-            {
-                correctColors++;
-                candidateCount[guess.colors[i]]--;
-            }
+    // Pegs the two patterns could pair up by color regardless of position: the sum over colors of the
+    // smaller count. A fixed-length loop without branches, which compiles to a vector min and add.
+    int commonColors(const ColorCounts &a, const ColorCounts &b)
+    {
+        int common = 0;
+        for (int c = 0; c < MAX_COLORS; ++c)
+        {
+            common += std::min(a[c], b[c]);
         }
+        return common;
+    }
+
+    // Code of a (correct position, correct color) score, also its index in a dense histogram.
+    // Codes run in the order Feedback sorts, and below (numPegs + 1)^2.
+    const int NUM_SCORES = (MAX_PEGS + 1) * (MAX_PEGS + 1);
 
+    int scoreIndex(int correctPosition, int correctColor, int numPegs)
+    {
+        return correctPosition * (numPegs + 1) + correctColor;
+    }
+
+    // Score code of guess against target from the color counts of both
+    int scoreCode(const Pattern &target, const ColorCounts &targetCounts,
+                  const Pattern &guess, const ColorCounts &guessCounts)
+    {
+        int correctPositions = exactMatches(target, guess);
+        int correctColors = commonColors(targetCounts, guessCounts) - correctPositions;
+        return scoreIndex(correctPositions, correctColors, guess.numPegs);
+    }
+
+    // Helper: Check if a pattern matches feedback constraints
+    bool matchesFeedback(const Pattern &candidate, const Feedback &fb)
+    {
+        const Pattern &guess = fb.guess;
+        if (candidate.numPegs != guess.numPegs)
+            return false;
+
+        // Correct positions first, most candidates are ruled out here
+        int correctPositions = exactMatches(candidate, guess);
+        if (correctPositions != fb.correctPosition)
+            return false;
+
+        // Colors in common, less those already in the right place
+        int correctColors = commonColors(colorCounts(candidate), colorCounts(guess)) - correctPositions;
         return correctColors == fb.correctColor;
     }
 
@@ -119,40 +187,12 @@ namespace Mastermind
         Feedback fb;
         fb.guess = guess; // Store the guess in the feedback
 
-        if (target.colors.size() != guess.colors.size())
+        if (target.numPegs != guess.numPegs)
             return fb; // Invalid input
 
-        // Count color occurrences in target
-        std::map<uint8_t, int> targetCount;
-        for (uint8_t color : target.colors)
-        {
-            targetCount[color]++;
-        }
-
-        // First pass: count correct positions
-        for (size_t i = 0; i < target.colors.size(); ++i)
-        {
-            if (target.colors[i] == guess.colors[i])
-            {
-                fb.correctPosition++;
-                targetCount[target.colors[i]]--;
-            }
-        }
-
-        // Second pass: count correct colors in wrong positions
-        for (size_t i = 0; i < guess.colors.size(); ++i)
-        {
-            // Skip positions that were already correct
-            if (target.colors[i] == guess.colors[i])
-                continue;
-
-            if (targetCount[guess.colors[i]] > 0)
-            {
-                fb.correctColor++;
-                targetCount[guess.colors[i]]--;
-            }
-        }
-
+        int correctPositions = exactMatches(target, guess);
+        fb.correctPosition = static_cast<uint8_t>(correctPositions);
+        fb.correctColor = static_cast<uint8_t>(commonColors(colorCounts(target), colorCounts(guess)) - correctPositions);
         return fb;
     }
 
@@ -172,22 +212,29 @@ namespace Mastermind
         if (possiblePatterns.empty())
             return 0.0;
 
-        std::map<Feedback, int> feedbackCounts;
-
-        // For each possible target pattern, generate feedback and count
+        // For each possible target pattern, score the guess and count
+        std::array<int, NUM_SCORES> feedbackCounts{};
+        ColorCounts guessCounts = colorCounts(guess);
+        const FeedbackTable *table = config.feedbackTable;
+        bool computeTiles = table != nullptr && possiblePatterns.size() * 2 >= table->size();
+        const uint8_t *row = (table != nullptr && !table->empty() && guess.index >= 0) ? table->row(guess.index, computeTiles) : nullptr;
         for (const auto &target : possiblePatterns)
         {
-            Feedback fb = generateFeedback(target, guess);
-            feedbackCounts[fb]++;
+            if (row != nullptr && target.index >= 0)
+                feedbackCounts[row[target.index]]++;
+            else
+                feedbackCounts[scoreCode(target, colorCounts(target), guess, guessCounts)]++;
         }
 
         // Calculate entropy
         double entropy = 0.0;
         int totalPatterns = possiblePatterns.size();
 
-        for (const auto &pair : feedbackCounts)
+        for (int count : feedbackCounts)
         {
-            double probability = static_cast<double>(pair.second) / totalPatterns;
+            if (count == 0)
+                continue;
+            double probability = static_cast<double>(count) / totalPatterns;
             entropy += probability * bits(probability);
         }
 
@@ -195,8 +242,12 @@ namespace Mastermind
     }
 
     // Generate all possible patterns for the given configuration
-    std::vector<Pattern> generateAllPatterns(const Config &config)
+    std::vector<Pattern> generateAllPatterns(const Config &config, FeedbackTable *table)
     {
+        if (config.numPegs > MAX_PEGS || config.numColors > MAX_COLORS)
+            throw std::runtime_error("Patterns are limited to " + std::to_string(MAX_PEGS) + " pegs of " +
+                                     std::to_string(MAX_COLORS) + " colors");
+
         std::vector<Pattern> patterns;
 
         if (config.allowDuplicates)
@@ -262,20 +313,238 @@ namespace Mastermind
             generate(0);
         }
 
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            patterns[i].index = static_cast<int>(i);
+        }
+        if (table != nullptr)
+            table->build(patterns, config);
         return patterns;
     }
 
+    PatternSet::PatternSet(size_t numPatterns) : bits(numPatterns / 64 + 1, 0)
+    {
+    }
+
+    void PatternSet::insert(const Pattern &pattern)
+    {
+        size_t i = static_cast<size_t>(pattern.index);
+        if (pattern.index >= 0 && i / 64 < bits.size())
+            bits[i >> 6] |= 1ULL << (i & 63);
+        else
+            unindexed.insert(pattern.pegs);
+    }
+
+    bool PatternSet::contains(const Pattern &pattern) const
+    {
+        size_t i = static_cast<size_t>(pattern.index);
+        if (pattern.index >= 0 && i / 64 < bits.size() && ((bits[i >> 6] >> (i & 63)) & 1))
+            return true;
+        return !unindexed.empty() && unindexed.count(pattern.pegs) > 0;
+    }
+
+    // --- Symmetry ---
+    SymmetryTracker::SymmetryTracker(const std::vector<Feedback> &history, const Config &config)
+        : numPegs(config.numPegs)
+    {
+        std::array<bool, MAX_COLORS> used{};
+        for (const auto &fb : history)
+        {
+            for (int i = 0; i < fb.guess.size(); ++i)
+            {
+                used[fb.guess.color(i)] = true;
+            }
+        }
+        for (int c = 0; c < config.numColors; ++c)
+        {
+            if (!used[c])
+                freeColors[numFree++] = static_cast<uint8_t>(c);
+        }
+
+        // A peg order fixes the history if the colors it moves onto each other can be renamed
+        // consistently: each used color must always land on the same color, and no two on one
+        std::array<int8_t, MAX_PEGS> order{};
+        for (int i = 0; i < numPegs; ++i)
+        {
+            order[i] = static_cast<int8_t>(i);
+        }
+        do
+        {
+            Relabeling relabeling;
+            relabeling.position = order;
+            relabeling.color.fill(-1);
+            std::array<bool, MAX_COLORS> taken{};
+            bool valid = true;
+            for (size_t h = 0; h < history.size() && valid; ++h)
+            {
+                const Pattern &guess = history[h].guess;
+                for (int i = 0; i < numPegs && valid; ++i)
+                {
+                    int from = guess.color(i);
+                    int to = guess.color(order[i]);
+                    if (relabeling.color[from] < 0 && !taken[to])
+                    {
+                        relabeling.color[from] = static_cast<int8_t>(to);
+                        taken[to] = true;
+                    }
+                    valid = relabeling.color[from] == to;
+                }
+            }
+            if (valid)
+                relabelings.push_back(relabeling);
+        } while (numPegs <= MAX_SYMMETRIC_PEGS && std::next_permutation(order.begin(), order.begin() + numPegs));
+    }
+
+    uint64_t SymmetryTracker::canonical(const Pattern &pattern) const
+    {
+        uint64_t best = pattern.pegs;
+        for (const auto &relabeling : relabelings)
+        {
+            // Move the pegs and rename the used colors, free colors are marked by -1 - color
+            std::array<int, MAX_PEGS> image{};
+            for (int i = 0; i < numPegs; ++i)
+            {
+                int c = pattern.color(i);
+                image[relabeling.position[i]] = (relabeling.color[c] >= 0) ? relabeling.color[c] : -1 - c;
+            }
+
+            // The smallest renaming of the free colors gives them out in order of first appearance
+            std::array<int8_t, MAX_COLORS> freeMap;
+            freeMap.fill(-1);
+            int nextFree = 0;
+            uint64_t pegs = 0;
+            for (int i = 0; i < numPegs; ++i)
+            {
+                int c = image[i];
+                if (c < 0)
+                {
+                    if (freeMap[-1 - c] < 0)
+                        freeMap[-1 - c] = static_cast<int8_t>(freeColors[nextFree++]);
+                    c = freeMap[-1 - c];
+                }
+                pegs = (pegs << 4) | static_cast<uint64_t>(c);
+            }
+            best = std::min(best, pegs);
+        }
+        return best;
+    }
+
+    // --- Feedback table ---
+    void FeedbackTable::build(const std::vector<Pattern> &allPatterns, const Config &config)
+    {
+        patterns.clear();
+        tiles.clear();
+        loadedTiles = 0;
+        if (allPatterns.empty() || (config.numPegs + 1) * (config.numPegs + 1) > 256)
+            return;
+
+        patterns = allPatterns;
+        counts.clear();
+        for (const auto &p : patterns)
+        {
+            counts.push_back(colorCounts(p));
+        }
+
+        // Tiles of about 1 MB, as many as the budget holds
+        size_t n = patterns.size();
+        tileRows = std::clamp<size_t>((1 << 20) / n, 1, n);
+        size_t numTiles = (n + tileRows - 1) / tileRows;
+        size_t budget = static_cast<size_t>(std::max(config.feedbackTableMB, 0)) << 20;
+        maxTiles = budget / (tileRows * n);
+        tiles.resize(numTiles);
+
+        // Compute a table that fits in full now, rather than during the first search
+        if (numTiles <= maxTiles)
+        {
+            for (size_t t = 0; t < numTiles; ++t)
+            {
+                tiles[t] = computeTile(t);
+            }
+            loadedTiles = numTiles;
+        }
+    }
+
+    std::unique_ptr<std::vector<uint8_t>> FeedbackTable::computeTile(size_t tile) const
+    {
+        size_t n = patterns.size();
+        size_t first = tile * tileRows;
+        size_t last = std::min(n, first + tileRows);
+
+        // The guess is copied out of the vectors, as stores through a byte pointer could alias them
+        auto codes = std::make_unique<std::vector<uint8_t>>((last - first) * n);
+        const Pattern *targets = patterns.data();
+        const ColorCounts *targetCounts = counts.data();
+        for (size_t g = first; g < last; ++g)
+        {
+            const Pattern guess = patterns[g];
+            const ColorCounts guessCounts = counts[g];
+            uint8_t *row = codes->data() + (g - first) * n;
+            for (size_t t = 0; t < n; ++t)
+            {
+                row[t] = static_cast<uint8_t>(scoreCode(targets[t], targetCounts[t], guess, guessCounts));
+            }
+        }
+        return codes;
+    }
+
+    const uint8_t *FeedbackTable::row(int guessIndex, bool compute) const
+    {
+        size_t tile = guessIndex / tileRows;
+        size_t offset = (guessIndex - tile * tileRows) * patterns.size();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tiles[tile] != nullptr)
+                return tiles[tile]->data() + offset;
+            if (!compute || loadedTiles >= maxTiles)
+                return nullptr;
+            loadedTiles++;
+        }
+
+        // Computed outside the lock, a tile is only ever written once it is complete
+        std::unique_ptr<std::vector<uint8_t>> codes = computeTile(tile);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tiles[tile] == nullptr)
+            tiles[tile] = std::move(codes);
+        else
+            loadedTiles--; // Another thread got there first
+        return tiles[tile]->data() + offset;
+    }
+
+    int FeedbackTable::rowOf(const Pattern &pattern) const
+    {
+        if (patterns.empty() || pattern.numPegs != patterns[0].numPegs)
+            return -1;
+        auto it = std::lower_bound(patterns.begin(), patterns.end(), pattern.pegs,
+                                   [](const Pattern &p, uint64_t pegs)
+                                   { return p.pegs < pegs; });
+        if (it == patterns.end() || it->pegs != pattern.pegs)
+            return -1;
+        return static_cast<int>(it - patterns.begin());
+    }
+
     std::vector<Pattern> filterPatterns(
         const std::vector<Pattern> &patterns,
-        const std::vector<Feedback> &guessHistory)
+        const std::vector<Feedback> &guessHistory,
+        const FeedbackTable *table)
     {
+        // Each feedback becomes a row of the table and the code the candidates must have in it
+        std::vector<const uint8_t *> rows;
+        std::vector<int> codes;
+        for (const Feedback &feedback : guessHistory)
+        {
+            int guessRow = (table != nullptr && !table->empty()) ? table->rowOf(feedback.guess) : -1;
+            rows.push_back(guessRow >= 0 ? table->row(guessRow, false) : nullptr);
+            codes.push_back(scoreIndex(feedback.correctPosition, feedback.correctColor, feedback.guess.numPegs));
+        }
+
         std::vector<Pattern> filtered;
         for (const auto &pattern : patterns)
         {
             bool matches = true;
-            for (const Feedback &feedback : guessHistory)
+            for (size_t f = 0; f < guessHistory.size(); ++f)
             {
-                if (!matchesFeedback(pattern, feedback))
+                bool fromTable = rows[f] != nullptr && pattern.index >= 0;
+                if (fromTable ? rows[f][pattern.index] != codes[f] : !matchesFeedback(pattern, guessHistory[f]))
                 {
                     matches = false;
                     break;
@@ -295,66 +564,160 @@ namespace Mastermind
         const Config &config,
         int recursionLevel)
     {
-        std::vector<PatternGuess> guesses;
+        // Child searches depend only on the candidate set and the remaining depth, so identical
+        // buckets reached through different guesses are answered from the cache. Candidates are told
+        // apart by their index, so only sets of generateAllPatterns patterns are cached.
+        CacheUtils::TranspositionCache<PatternGuess> *cache = (recursionLevel > 0) ? config.cache : nullptr;
+        uint64_t fingerprint = 0;
+        std::vector<int> ids;
+        if (cache != nullptr)
+        {
+            ids.reserve(possiblePatterns.size());
+            for (const auto &p : possiblePatterns)
+            {
+                if (p.index < 0)
+                {
+                    cache = nullptr;
+                    break;
+                }
+                ids.push_back(p.index);
+            }
+        }
+        if (cache != nullptr)
+        {
+            fingerprint = CacheUtils::fingerprint(ids);
+            PatternGuess cached;
+            if (cache->find(fingerprint, config.maxDepth, cached))
+                return {cached};
+        }
 
         // Create a set for fast O(1) lookups.
-        std::unordered_set<std::string> possiblePatternSet;
+        PatternSet possiblePatternSet(allPatterns.size());
         for (const auto &p : possiblePatterns)
         {
-            possiblePatternSet.insert(p.toString());
+            possiblePatternSet.insert(p);
         }
 
-        // Calculate entropy for each potential guess
-        for (const auto &pattern : allPatterns)
+        // Color counts of the candidates, shared by every guess scored against them, and their columns in
+        // the feedback table if they all have one
+        std::vector<ColorCounts> targetCounts;
+        targetCounts.reserve(possiblePatterns.size());
+        const FeedbackTable *table = (config.feedbackTable != nullptr && !config.feedbackTable->empty()) ? config.feedbackTable : nullptr;
+        for (const auto &p : possiblePatterns)
+        {
+            targetCounts.push_back(colorCounts(p));
+            if (p.index < 0)
+                table = nullptr;
+        }
+        // Missing tiles are computed only for a search over at least half the patterns
+        bool computeTiles = table != nullptr && possiblePatterns.size() * 2 >= table->size();
+
+        ThreadUtils::Deadline *deadline = config.deadline;
+        if (recursionLevel > 0 && deadline != nullptr && deadline->expired())
+            return {};
+
+        // Guesses a relabeling fixing the history maps onto each other score the same, so only the
+        // smallest of each class, its canonical pattern, is scored
+        std::vector<uint64_t> classOf; // Canonical pattern of each guess, empty if every guess is scored
+        std::vector<size_t> scoredGuesses;
+        if (config.useSymmetry)
+        {
+            SymmetryTracker symmetry(guessHistory, config);
+            if (!symmetry.trivial())
+            {
+                classOf.resize(allPatterns.size());
+                for (size_t g = 0; g < allPatterns.size(); ++g)
+                {
+                    classOf[g] = symmetry.canonical(allPatterns[g]);
+                    if (classOf[g] == allPatterns[g].pegs)
+                        scoredGuesses.push_back(g);
+                }
+            }
+        }
+        if (classOf.empty())
+        {
+            scoredGuesses.resize(allPatterns.size());
+            std::iota(scoredGuesses.begin(), scoredGuesses.end(), 0);
+        }
+
+        // Score one guess with entropy levels down to depth, searching each feedback bucket below it
+        auto scoreGuess = [&](const Pattern &pattern, int depth)
         {
             PatternGuess guess;
             guess.pattern = pattern;
 
+            // A child's candidates are those left by the history plus this guess, which is what its
+            // symmetries are found from
+            std::vector<Feedback> childHistory;
+            if (depth > 1 && config.useSymmetry)
+            {
+                childHistory = guessHistory;
+                childHistory.push_back(Feedback{pattern});
+            }
+
             // Initialize entropy levels
             std::vector<double> entropyList(config.maxDepth, 0.0);
             double firstLevelEntropy = 0.0;
 
-            // Generate all possible feedback patterns for this guess
-            std::map<Feedback, int> feedbackCounts;
-            for (const auto &target : possiblePatterns)
+            // Count the targets by (correct position, correct color), grouping them by score when
+            // searching deeper so each child gets its candidates directly
+            std::array<int, NUM_SCORES> feedbackCounts{};
+            std::vector<std::vector<Pattern>> feedbackBuckets(depth > 1 ? NUM_SCORES : 0);
+            const uint8_t *row = (table != nullptr && pattern.index >= 0) ? table->row(pattern.index, computeTiles) : nullptr;
+            ColorCounts guessCounts = colorCounts(pattern);
+            for (size_t t = 0; t < possiblePatterns.size(); ++t)
             {
-                Feedback fb = generateFeedback(target, pattern);
-                feedbackCounts[fb]++;
+                int score = (row != nullptr) ? row[possiblePatterns[t].index]
+                                             : scoreCode(possiblePatterns[t], targetCounts[t], pattern, guessCounts);
+                feedbackCounts[score]++;
+                if (depth > 1)
+                    feedbackBuckets[score].push_back(possiblePatterns[t]);
             }
 
-            // Calculate first level entropy and prepare for deeper levels
-            for (const auto &pair : feedbackCounts)
+            // Calculate first level entropy and prepare for deeper levels, in score order. The other
+            // strategies' measures come from the same counts.
+            int numScores = (pattern.numPegs + 1) * (pattern.numPegs + 1);
+            double sumSquares = 0.0;
+            for (int score = 0; score < numScores; ++score)
             {
-                double probability = static_cast<double>(pair.second) / possiblePatterns.size();
+                if (feedbackCounts[score] == 0)
+                    continue;
+                guess.largestPart = std::max(guess.largestPart, feedbackCounts[score]);
+                guess.numParts++;
+                sumSquares += static_cast<double>(feedbackCounts[score]) * feedbackCounts[score];
+                double probability = static_cast<double>(feedbackCounts[score]) / possiblePatterns.size();
                 double info = bits(probability);
 
                 if (probability > 0)
                 {
                     firstLevelEntropy += probability * info;
 
-                    // Calculate deeper entropy if maxDepth > 1
-                    if (config.maxDepth > 1)
+                    // Calculate deeper entropy if depth > 1
+                    if (depth > 1)
                     {
-                        // Create guess history with this feedback
-                        auto tempHistory = guessHistory;
-                        tempHistory.push_back(pair.first);
-
-                        std::vector<Pattern> filteredPatterns = filterPatterns(allPatterns, tempHistory);
+                        // The patterns left after this feedback are exactly this guess's bucket
+                        const std::vector<Pattern> &filteredPatterns = feedbackBuckets[score];
 
                         if (!filteredPatterns.empty())
                         {
                             // Recursively calculate best guess for deeper levels
                             Config nextConfig = config;
-                            nextConfig.maxDepth = config.maxDepth - 1;
+                            nextConfig.maxDepth = depth - 1;
+                            if (!childHistory.empty())
+                            {
+                                childHistory.back().correctPosition = static_cast<uint8_t>(score / (pattern.numPegs + 1));
+                                childHistory.back().correctColor = static_cast<uint8_t>(score % (pattern.numPegs + 1));
+                            }
 
                             std::vector<PatternGuess> nextBestGuesses = calculateBestGuesses(
-                                allPatterns, filteredPatterns, tempHistory, nextConfig, recursionLevel + 1);
+                                allPatterns, filteredPatterns, childHistory.empty() ? guessHistory : childHistory,
+                                nextConfig, recursionLevel + 1);
 
                             if (!nextBestGuesses.empty())
                             {
                                 const PatternGuess &bestNextGuess = nextBestGuesses[0];
                                 // Add weighted entropy from next levels (like mastermind)
-                                for (int i = 0; i < config.maxDepth - 1 && i < bestNextGuess.entropyList.size(); i++)
+                                for (int i = 0; i < depth - 1 && i < bestNextGuess.entropyList.size(); i++)
                                 {
                                     double additionalEntropy = -bits(possiblePatterns.size()) +
                                                                (bits(filteredPatterns.size()) + bestNextGuess.entropyList[i]);
@@ -368,24 +731,108 @@ namespace Mastermind
 
             entropyList[0] = firstLevelEntropy;
             guess.entropy = firstLevelEntropy;
+            guess.expectedSize = possiblePatterns.empty() ? 0.0 : sumSquares / possiblePatterns.size();
             guess.entropyList = entropyList;
+            guess.scoredDepth = depth;
 
             // Calculate probability of this pattern being the answer
-            bool isPossible = possiblePatternSet.count(pattern.toString());
+            bool isPossible = possiblePatternSet.contains(pattern);
             guess.probability = isPossible ? (1.0 / possiblePatterns.size()) : 0.0;
 
-            guesses.push_back(guess);
+            return guess;
+        };
+
+        // An anytime search scores every guess to depth 1 first, then deepens one level at a time in
+        // order of the current ranking. A guess whose search ran past the deadline keeps its previous
+        // score, and a child search out of time gives up since its result is dropped.
+        bool anytime = recursionLevel == 0 && deadline != nullptr && config.maxDepth > 1;
+
+        // Only the top level is split across threads, each guess is written in place so the result
+        // does not depend on scheduling
+        int numThreads = (recursionLevel == 0) ? ThreadUtils::resolveThreadCount(config.numThreads) : 1;
+        std::optional<ThreadUtils::ThreadPool> pool;
+        if (numThreads > 1 && allPatterns.size() > 1)
+            pool.emplace(numThreads);
+        auto forEachGuess = [&](size_t count, const std::function<void(size_t)> &body)
+        {
+            if (pool)
+            {
+                pool->parallelFor(count, 16, [&](int, size_t begin, size_t end)
+                                  {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        body(i);
+                    } });
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    body(i);
+                }
+            }
+        };
+
+        std::vector<PatternGuess> guesses(scoredGuesses.size());
+        if (pool)
+        {
+            forEachGuess(scoredGuesses.size(), [&](size_t g)
+                         { guesses[g] = scoreGuess(allPatterns[scoredGuesses[g]], anytime ? 1 : config.maxDepth); });
+        }
+        else
+        {
+            for (size_t g = 0; g < scoredGuesses.size(); ++g)
+            {
+                guesses[g] = scoreGuess(allPatterns[scoredGuesses[g]], anytime ? 1 : config.maxDepth);
+                if (recursionLevel > 0 && deadline != nullptr && deadline->expired())
+                    return {};
+            }
         }
 
-        // Sort by entropy levels (highest priority first)
-        std::sort(guesses.begin(), guesses.end());
+        sortGuesses(guesses, config.strategy);
+
+        // Guesses rescored after the deadline keep their previous score
+        std::atomic<bool> outOfTime{false};
+        for (int depth = 2; anytime && depth <= config.maxDepth && !outOfTime; ++depth)
+        {
+            forEachGuess(guesses.size(), [&](size_t g)
+                         {
+                if (outOfTime)
+                    return;
+                PatternGuess scored = scoreGuess(guesses[g].pattern, depth);
+                if (deadline->expired())
+                    outOfTime = true;
+                else
+                    guesses[g] = std::move(scored); });
+            sortGuesses(guesses, config.strategy);
+        }
 
         // For recursive calls, only return the best guess to save computation
         if (recursionLevel > 0 && !guesses.empty())
         {
+            if (cache != nullptr)
+                cache->insert(fingerprint, config.maxDepth, guesses[0]);
             return {guesses[0]};
         }
 
+        // Every guess takes the score of its class
+        if (!classOf.empty())
+        {
+            std::unordered_map<uint64_t, size_t> scoreOfClass;
+            for (size_t k = 0; k < guesses.size(); ++k)
+            {
+                scoreOfClass[guesses[k].pattern.pegs] = k;
+            }
+            std::vector<PatternGuess> allGuesses(allPatterns.size());
+            for (size_t g = 0; g < allPatterns.size(); ++g)
+            {
+                allGuesses[g] = guesses[scoreOfClass[classOf[g]]];
+                allGuesses[g].pattern = allPatterns[g];
+            }
+            sortGuesses(allGuesses, config.strategy);
+            guesses = std::move(allGuesses);
+        }
+
         return guesses;
     }
 
@@ -396,9 +843,10 @@ namespace Mastermind
         const Config &config)
     {
         Result result;
+        ThreadUtils::Deadline deadline(config.timeBudgetMs);
 
         // First filter patterns based on existing feedback
-        std::vector<Pattern> possiblePatterns = filterPatterns(allPatterns, guessHistory);
+        std::vector<Pattern> possiblePatterns = filterPatterns(allPatterns, guessHistory, config.feedbackTable);
         result.totalPossiblePatterns = possiblePatterns.size();
 
         if (config.maxDepth == 0)
@@ -416,8 +864,21 @@ namespace Mastermind
         else
         {
             // Calculate best guesses with entropy for all patterns
-            std::vector<PatternGuess> allGuesses = calculateBestGuesses(allPatterns, possiblePatterns, guessHistory, config);
+            CacheUtils::TranspositionCache<PatternGuess> cache(config.cacheSize);
+            Config searchConfig = config;
+            if (searchConfig.cache == nullptr && config.cacheSize > 0 && config.maxDepth > 1)
+                searchConfig.cache = &cache;
+            if (searchConfig.deadline == nullptr && config.timeBudgetMs > 0)
+                searchConfig.deadline = &deadline;
+
+            std::vector<PatternGuess> allGuesses = calculateBestGuesses(allPatterns, possiblePatterns, guessHistory, searchConfig);
             result.sortedGuesses = allGuesses;
+
+            if (searchConfig.cache != nullptr)
+            {
+                result.cacheHits = searchConfig.cache->getHits();
+                result.cacheMisses = searchConfig.cache->getMisses();
+            }
         }
 
         return result;
@@ -4,53 +4,147 @@
 #include <array>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <cmath>
+#include <memory>
+#include <mutex>
 
 #include "utils.hpp"
 
 namespace Mastermind
 {
+    struct PatternGuess;
+    class FeedbackTable;
+
+    const int MAX_PEGS = 16;   // A pattern packs 4 bits per peg into 64 bits
+    const int MAX_COLORS = 16; // Colors that fit in 4 bits
+    const int MAX_SYMMETRIC_PEGS = 6; // Peg relabelings are only searched up to this many pegs (720 orders)
+
+    // How guesses are ranked. Every strategy reads the same partition of the candidates by feedback.
+    enum class Strategy
+    {
+        Entropy,     // Most information, deeper levels first
+        Minimax,     // Smallest largest partition (Knuth), the fewest candidates left in the worst case
+        MostParts,   // Most partitions
+        ExpectedSize // Smallest expected number of candidates left
+    };
+
     struct Config
     {
         int numPegs = 4;             // Number of pegs in the pattern
         int numColors = 6;           // Total number of available colors (0 to numColors-1)
         bool allowDuplicates = true; // Whether duplicate colors are allowed
         int maxDepth = 0;            // How many moves ahead to calculate entropy
+        int cacheSize = 100000;      // Max memoized child searches per solve, 0 disables
+        int timeBudgetMs = 0;        // Anytime search deadline per solve, 0 = none
+        int feedbackTableMB = 256;   // Memory for the feedback table, larger tables are computed in tiles on demand
+        int numThreads = 0;          // Threads scoring top-level guesses, 0 = one per hardware thread
+        bool useSymmetry = true;     // Score one guess per class of guesses the history can't tell apart
+        Strategy strategy = Strategy::Entropy;
+
+        const FeedbackTable *feedbackTable = nullptr;                  // Scores of every guess against every pattern
+        CacheUtils::TranspositionCache<PatternGuess> *cache = nullptr; // Shared by the child searches of one solve
+        ThreadUtils::Deadline *deadline = nullptr;                     // Set from timeBudgetMs for one solve
     };
 
+    // Colors packed 4 bits per peg, the first peg in the highest nibble, so comparing the packed values
+    // orders patterns like comparing their colors peg by peg. Copying one never allocates.
     struct Pattern
     {
-        std::vector<uint8_t> colors; // Array of color values
-        int order = 0;               // For compatibility with Word structure
-        int count = 1;               // For compatibility with Word structure
+        uint64_t pegs = 0;   // Color of peg i in bits 4 * (numPegs - 1 - i)
+        uint8_t numPegs = 0;
+        int index = -1;      // Position in generateAllPatterns' list, -1 if not from there
 
         Pattern() = default;
-        Pattern(const std::vector<uint8_t> &c) : colors(c) {}
-        Pattern(int numPegs) : colors(numPegs, 0) {}
+        Pattern(const std::vector<uint8_t> &colors) : numPegs(static_cast<uint8_t>(colors.size()))
+        {
+            for (uint8_t color : colors)
+            {
+                pegs = (pegs << 4) | (color & 0xF);
+            }
+        }
+        Pattern(int numPegs) : numPegs(static_cast<uint8_t>(numPegs)) {}
+
+        int size() const { return numPegs; }
+        uint8_t color(int i) const { return static_cast<uint8_t>((pegs >> (4 * (numPegs - 1 - i))) & 0xF); }
 
         bool operator<(const Pattern &other) const
         {
-            return colors < other.colors;
+            if (numPegs != other.numPegs)
+                return numPegs < other.numPegs;
+            return pegs < other.pegs;
         }
 
         bool operator==(const Pattern &other) const
         {
-            return colors == other.colors;
+            return pegs == other.pegs && numPegs == other.numPegs;
         }
 
         std::string toString() const
         {
             std::string result;
-            for (size_t i = 0; i < colors.size(); ++i)
+            for (int i = 0; i < numPegs; ++i)
             {
                 if (i > 0)
                     result += " ";
-                result += std::to_string(colors[i]);
+                result += std::to_string(color(i));
             }
             return result;
         }
     };
 
+    // Set of patterns with one bit per index in a generateAllPatterns list of numPatterns patterns.
+    // Patterns from outside the list are kept by their packed pegs.
+    class PatternSet
+    {
+    public:
+        PatternSet(size_t numPatterns);
+
+        void insert(const Pattern &pattern);
+        bool contains(const Pattern &pattern) const;
+
+    private:
+        std::vector<uint64_t> bits;
+        std::unordered_set<uint64_t> unindexed;
+    };
+
+    // Score code of every guess against every pattern of a generateAllPatterns list, one byte per pair:
+    // correctPosition * (numPegs + 1) + correctColor. Row g holds guess g against each pattern.
+    // A table within config.feedbackTableMB is computed up front. A larger one is cut into tiles of rows,
+    // each computed on first use and kept while the budget lasts. A search reads every row once per
+    // node, in the same order, so evicting would only trade one miss for another; rows past the
+    // budget are scored directly instead. A tile scores a guess against every pattern, so it is only
+    // worth computing for a search over a large share of them.
+    class FeedbackTable
+    {
+    public:
+        FeedbackTable() = default;
+
+        // Keep the patterns, in generateAllPatterns' ascending order of pegs, and compute the table, or
+        // only size its tiles if it doesn't fit. Leaves the table empty if a code doesn't fit in a byte.
+        void build(const std::vector<Pattern> &patterns, const Config &config);
+
+        bool empty() const { return patterns.empty(); }
+        size_t size() const { return patterns.size(); }
+
+        // Codes of guess guessIndex against every pattern. nullptr if its tile isn't computed yet and
+        // either compute is false or the budget is full.
+        const uint8_t *row(int guessIndex, bool compute = true) const;
+        int rowOf(const Pattern &pattern) const; // Binary search of the patterns, -1 if it isn't in the table
+
+    private:
+        std::vector<Pattern> patterns;
+        std::vector<std::array<uint8_t, MAX_COLORS>> counts; // Pegs of each color per pattern
+        size_t tileRows = 0;
+        size_t maxTiles = 0;
+
+        mutable std::mutex mutex;
+        mutable std::vector<std::unique_ptr<std::vector<uint8_t>>> tiles;
+        mutable size_t loadedTiles = 0;
+
+        std::unique_ptr<std::vector<uint8_t>> computeTile(size_t tile) const;
+    };
+
     struct Feedback
     {
         Pattern guess;               // The guessed pattern
@@ -59,27 +153,61 @@ namespace Mastermind
 
         bool operator==(const Feedback &other) const
         {
-            return guess.colors == other.guess.colors &&
+            return guess == other.guess &&
                    correctPosition == other.correctPosition &&
                    correctColor == other.correctColor;
         }
 
         bool operator<(const Feedback &other) const
         {
-            if (guess.colors != other.guess.colors)
-                return guess.colors < other.guess.colors;
+            if (!(guess == other.guess))
+                return guess < other.guess;
             if (correctPosition != other.correctPosition)
                 return correctPosition < other.correctPosition;
             return correctColor < other.correctColor;
         }
     };
 
+    // The relabelings of colors and pegs that map every guess of a history to itself. A relabeling maps
+    // the patterns left by the history onto themselves and keeps every feedback, so two guesses related
+    // by one score the same at every depth. Colors no guess used can always be swapped, pegs only as
+    // the guesses allow, and only up to MAX_SYMMETRIC_PEGS pegs.
+    class SymmetryTracker
+    {
+    public:
+        SymmetryTracker(const std::vector<Feedback> &history, const Config &config);
+
+        // True if no two patterns are related, every pattern is its own class
+        bool trivial() const { return relabelings.size() == 1 && numFree <= 1; }
+
+        // The smallest pattern a relabeling maps pattern to, the same for every pattern of its class
+        uint64_t canonical(const Pattern &pattern) const;
+
+    private:
+        struct Relabeling
+        {
+            std::array<int8_t, MAX_PEGS> position; // Peg i moves to position[i]
+            std::array<int8_t, MAX_COLORS> color;  // Image of each used color, -1 for free colors
+        };
+
+        std::vector<Relabeling> relabelings;
+        std::array<uint8_t, MAX_COLORS> freeColors{}; // Colors no guess used, ascending
+        int numFree = 0;
+        int numPegs = 0;
+    };
+
     struct PatternGuess
     {
         Pattern pattern;
         double entropy = 0.0;
         double probability = 0.0;
         std::vector<double> entropyList;
+        int scoredDepth = 0; // Levels of entropyList computed exactly, deeper levels are left at 0
+
+        // The guess's partition of the candidates, filled for every strategy
+        int largestPart = 0;       // Candidates left by the worst feedback
+        int numParts = 0;          // Distinct feedbacks
+        double expectedSize = 0.0; // Candidates left on average
 
         bool operator<(const PatternGuess &other) const
         {
@@ -104,7 +232,7 @@ namespace Mastermind
                 return probability > other.probability; // Sort in descending order (higher probability first)
 
             // If both entropy and probability are equal, sort by pattern for consistency
-            return pattern.colors < other.pattern.colors;
+            return pattern < other.pattern;
         }
     };
 
@@ -112,8 +240,17 @@ namespace Mastermind
     {
         std::vector<PatternGuess> sortedGuesses;
         int totalPossiblePatterns = 0;
+        long long cacheHits = 0;
+        long long cacheMisses = 0;
     };
 
+    // Parse a strategy name: entropy, minimax, parts or expected
+    Strategy parseStrategy(const std::string &name);
+
+    // Sort guesses best first by strategy. Guesses equal under a partition strategy rank candidates
+    // first, then by entropy. Re-sorting by another strategy needs no rescoring.
+    void sortGuesses(std::vector<PatternGuess> &guesses, Strategy strategy);
+
     // Parse feedback string like "2 1" (2 correct position, 1 correct color)
     Feedback parseFeedback(const std::string &input, int numPegs);
 
@@ -128,15 +265,25 @@ namespace Mastermind
                             const Pattern &guess,
                             const Config &config);
 
-    // Generate all possible patterns for the given configuration
-    std::vector<Pattern> generateAllPatterns(const Config &config);
+    // Generate all possible patterns for the given configuration, each knowing its index in the list.
+    // With a table, also builds the feedback table of the patterns into it.
+    // Throws if there are more than MAX_PEGS pegs or MAX_COLORS colors.
+    std::vector<Pattern> generateAllPatterns(const Config &config, FeedbackTable *table = nullptr);
 
-    // Filter possible patterns given a list of guesses and feedbacks
+    // Filter possible patterns given a list of guesses and feedbacks.
+    // Patterns of the table's list are checked with one lookup per feedback.
     std::vector<Pattern> filterPatterns(
         const std::vector<Pattern> &patterns,
-        const std::vector<Feedback> &guessHistory);
+        const std::vector<Feedback> &guessHistory,
+        const FeedbackTable *table = nullptr);
 
-    // Calculate best guesses sorted by information value with multi-depth entropy
+    // Calculate best guesses sorted by config.strategy, with multi-depth entropy.
+    // possiblePatterns must be the patterns satisfying guessHistory; deeper levels search each feedback bucket of it,
+    // playing the best guess of the strategy there. Only the top level runs on config.numThreads.
+    // With config.useSymmetry only one guess per SymmetryTracker class of guessHistory is scored, the
+    // top level copies its score to the rest of the class.
+    // With config.deadline the top level scores depth 1 in full, then deepens one level at a time, most
+    // promising guesses first, until the deadline; PatternGuess::scoredDepth tells how far each one got.
     std::vector<PatternGuess> calculateBestGuesses(
         const std::vector<Pattern> &allPatterns,
         const std::vector<Pattern> &possiblePatterns,
@@ -10,6 +10,18 @@
 #include <filesystem>
 #include <set>
 #include <sstream>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "utils.hpp"
 
@@ -169,6 +181,13 @@ namespace ProfilerUtils
         logFile.close();
     }
 
+    void Profiler::addCount(const std::string &counterName, long long amount)
+    {
+        if (counters.find(counterName) == counters.end())
+            counterList.push_back(counterName);
+        counters[counterName] += amount;
+    }
+
     void Profiler::updateProfile(const std::string &functionName, bool start)
     {
         double t = getTime();
@@ -221,6 +240,8 @@ namespace ProfilerUtils
         this->profilerUpdater = &main.childProfileMap.at("Profiler");
 
         this->currentProfile = &this->main;
+        this->counters.clear();
+        this->counterList.clear();
     }
 
     void Profiler::end()
@@ -260,6 +281,14 @@ namespace ProfilerUtils
             log("Profiler Data: Average time, Count, Total time, Percent");
             logChildProfiles(main, 1);
         }
+        if (!counterList.empty())
+        {
+            log("Counters:");
+            for (const std::string &name : counterList)
+            {
+                log("     " + name + ": " + std::to_string(counters.at(name)));
+            }
+        }
         log("");
     }
 
@@ -401,6 +430,251 @@ namespace WordUtils
             }
             out.close();
         }
+
+        for (size_t i = 0; i < allWordsVec.size(); ++i)
+        {
+            allWordsVec[i].index = static_cast<int>(i);
+        }
         return allWordsVec;
     }
-} // namespace WordUtils
\ No newline at end of file
+} // namespace WordUtils
+
+namespace FileUtils
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(mappedData, other.mappedData);
+            std::swap(mappedSize, other.mappedSize);
+#ifdef _WIN32
+            std::swap(fileHandle, other.fileHandle);
+            std::swap(mappingHandle, other.mappingHandle);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::filesystem::path &path)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        fileHandle = file;
+        mappingHandle = mapping;
+        mappedData = static_cast<const uint8_t *>(view);
+        mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // The mapping stays valid after the descriptor is closed
+        if (view == MAP_FAILED)
+            return false;
+        mappedData = static_cast<const uint8_t *>(view);
+        mappedSize = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (mappedData == nullptr)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(mappedData);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(const_cast<uint8_t *>(mappedData), mappedSize);
+#endif
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+} // namespace FileUtils
+
+namespace ThreadUtils
+{
+    int resolveThreadCount(int requested)
+    {
+        if (requested > 0)
+            return requested;
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads == 0 ? 1 : static_cast<int>(hardwareThreads);
+    }
+
+    Deadline::Deadline(int budgetMs)
+        : end(std::chrono::steady_clock::now() + std::chrono::milliseconds(budgetMs)), unlimited(budgetMs <= 0)
+    {
+    }
+
+    bool Deadline::expired()
+    {
+        if (unlimited)
+            return false;
+        if (passed.load(std::memory_order_relaxed))
+            return true;
+        if (std::chrono::steady_clock::now() < end)
+            return false;
+        passed.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    ThreadPool::ThreadPool(int numThreads)
+    {
+        int total = resolveThreadCount(numThreads);
+        for (int i = 1; i < total; ++i)
+        {
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(int, size_t, size_t)> &body)
+    {
+        if (count == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            jobCount = count;
+            jobChunkSize = chunkSize == 0 ? 1 : chunkSize;
+            jobError = nullptr;
+            nextIndex = 0;
+            activeWorkers = static_cast<int>(workers.size());
+            jobGeneration++;
+        }
+        jobReady.notify_all();
+
+        runChunks(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [this]
+                     { return activeWorkers == 0; });
+        job = nullptr;
+        if (jobError)
+            std::rethrow_exception(jobError);
+    }
+
+    void ThreadPool::workerLoop(int workerIndex)
+    {
+        uint64_t seenGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobReady.wait(lock, [&]
+                              { return stopping || jobGeneration != seenGeneration; });
+                if (stopping)
+                    return;
+                seenGeneration = jobGeneration;
+            }
+
+            runChunks(workerIndex);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--activeWorkers == 0)
+                jobDone.notify_one();
+        }
+    }
+
+    void ThreadPool::runChunks(int workerIndex)
+    {
+        while (true)
+        {
+            size_t begin = nextIndex.fetch_add(jobChunkSize);
+            if (begin >= jobCount)
+                return;
+            size_t end = std::min(begin + jobChunkSize, jobCount);
+            try
+            {
+                (*job)(workerIndex, begin, end);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!jobError)
+                    jobError = std::current_exception();
+                nextIndex = jobCount; // Stop handing out work
+            }
+        }
+    }
+} // namespace ThreadUtils
+
+namespace CacheUtils
+{
+    uint64_t fingerprint(std::vector<int> ids)
+    {
+        std::sort(ids.begin(), ids.end());
+
+        // FNV-1a over the sorted ids, finished with a 64-bit mix so nearby sets spread out
+        uint64_t hash = 1469598103934665603ULL;
+        for (int id : ids)
+        {
+            hash ^= static_cast<uint32_t>(id);
+            hash *= 1099511628211ULL;
+        }
+        hash ^= ids.size();
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+} // namespace CacheUtils
\ No newline at end of file
@@ -4,6 +4,16 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <list>
+#include <unordered_map>
 
 namespace ProfilerUtils
 {
@@ -55,8 +65,12 @@ namespace ProfilerUtils
         double startTime;
         double endTime;
 
+        std::map<std::string, long long> counters;
+        std::vector<std::string> counterList;
+
         Profiler();
         void log(const std::string &message);
+        void addCount(const std::string &counterName, long long amount = 1);
         void updateProfile(const std::string &functionName, bool start);
         void profileStart(const std::string &functionName, bool ignore = false);
         void profileEnd(const std::string &functionName, bool ignore = false);
@@ -78,6 +92,7 @@ namespace WordUtils
         int count;
         int uniqueLetters;
         std::array<uint8_t, 26> letterCount; // Count of each letter a-z
+        int index = -1;                      // Position in the loaded word list
         bool operator<(const Word &other) const { return wordString < other.wordString; }
     };
 
@@ -86,4 +101,162 @@ namespace WordUtils
     std::vector<Word> loadWords();
 
     // Other utility functions related to words can be declared here
-} // namespace WordUtils
\ No newline at end of file
+} // namespace WordUtils
+
+namespace FileUtils
+{
+    // Read-only memory mapping of a whole file
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool open(const std::filesystem::path &path);
+        void close();
+        const uint8_t *data() const { return mappedData; }
+        size_t size() const { return mappedSize; }
+
+    private:
+        const uint8_t *mappedData = nullptr;
+        size_t mappedSize = 0;
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+    };
+} // namespace FileUtils
+
+namespace ThreadUtils
+{
+    // Resolve a requested thread count, 0 or less means one per hardware thread
+    int resolveThreadCount(int requested);
+
+    // Fixed set of worker threads that split index ranges between them.
+    // The calling thread works as worker 0, so a pool of size 1 runs everything inline.
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(int numThreads = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        int size() const { return static_cast<int>(workers.size()) + 1; }
+
+        // Calls body(workerIndex, begin, end) for chunks of [0, count) and blocks until all are done.
+        // Chunks are handed out dynamically; the first exception thrown by body is rethrown here.
+        void parallelFor(size_t count, size_t chunkSize, const std::function<void(int, size_t, size_t)> &body);
+
+    private:
+        void workerLoop(int workerIndex);
+        void runChunks(int workerIndex);
+
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable jobReady;
+        std::condition_variable jobDone;
+        const std::function<void(int, size_t, size_t)> *job = nullptr;
+        size_t jobCount = 0;
+        size_t jobChunkSize = 1;
+        std::atomic<size_t> nextIndex{0};
+        int activeWorkers = 0;
+        uint64_t jobGeneration = 0;
+        bool stopping = false;
+        std::exception_ptr jobError;
+    };
+
+    // Wall-clock limit shared by the threads of one search. Once expired it stays expired,
+    // so work finished before the first expired() == true is known to be complete.
+    class Deadline
+    {
+    public:
+        explicit Deadline(int budgetMs); // 0 or less never expires
+
+        bool expired();
+
+    private:
+        std::chrono::steady_clock::time_point end;
+        bool unlimited;
+        std::atomic<bool> passed{false};
+    };
+} // namespace ThreadUtils
+
+namespace CacheUtils
+{
+    // Order-independent fingerprint of a set of candidate ids
+    uint64_t fingerprint(std::vector<int> ids);
+
+    // Bounded LRU memo of search results keyed by candidate-set fingerprint and remaining depth.
+    // Safe to share between threads.
+    template <typename Value>
+    class TranspositionCache
+    {
+    public:
+        explicit TranspositionCache(size_t capacity) : capacity(capacity) {}
+
+        bool find(uint64_t fingerprint, int depth, Value &value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(Key{fingerprint, depth});
+            if (it == index.end())
+            {
+                misses++;
+                return false;
+            }
+            entries.splice(entries.begin(), entries, it->second);
+            value = it->second->second;
+            hits++;
+            return true;
+        }
+
+        void insert(uint64_t fingerprint, int depth, const Value &value)
+        {
+            if (capacity == 0)
+                return;
+            std::lock_guard<std::mutex> lock(mutex);
+            Key key{fingerprint, depth};
+            auto it = index.find(key);
+            if (it != index.end())
+            {
+                it->second->second = value;
+                entries.splice(entries.begin(), entries, it->second);
+                return;
+            }
+            entries.emplace_front(key, value);
+            index[key] = entries.begin();
+            if (entries.size() > capacity)
+            {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+
+        long long getHits() const { return hits; }
+        long long getMisses() const { return misses; }
+
+    private:
+        struct Key
+        {
+            uint64_t fingerprint;
+            int depth;
+            bool operator==(const Key &other) const { return fingerprint == other.fingerprint && depth == other.depth; }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &k) const { return std::hash<uint64_t>()(k.fingerprint ^ (static_cast<uint64_t>(k.depth) << 56)); }
+        };
+
+        size_t capacity;
+        std::list<std::pair<Key, Value>> entries; // Most recently used first
+        std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, KeyHash> index;
+        std::mutex mutex;
+        std::atomic<long long> hits{0};
+        std::atomic<long long> misses{0};
+    };
+} // namespace CacheUtils
\ No newline at end of file
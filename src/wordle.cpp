@@ -8,25 +8,199 @@
 #include <map>
 #include <unordered_map>
 #include <unordered_set>
+#include <set>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <tuple>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 #include "utils.hpp"
 #include "wordle.hpp"
 
 namespace Wordle
 {
+    const std::array<uint8_t, 5> FEEDBACK_POWERS = {1, 3, 9, 27, 81};
+    const char FEEDBACK_MATRIX_MAGIC[8] = {'W', 'G', 'F', 'B', 'M', 'A', 'T', '1'};
+
+    // --- Lexicon ---
+    Lexicon::Lexicon(const std::vector<WordUtils::Word> &allWords)
+    {
+        rowOfIndex.assign(allWords.size(), -1);
+
+        // FNV-1a over the word strings so tables can detect a changed corpus
+        checksum = 1469598103934665603ULL;
+        for (size_t i = 0; i < allWords.size(); ++i)
+        {
+            const WordUtils::Word &word = allWords[i];
+            if (word.wordString.size() != 5)
+                continue;
+
+            int row = static_cast<int>(words.size());
+            words.push_back(word);
+            rowOfIndex[i] = row;
+            rowOfWord[word.wordString] = row;
+
+            for (char c : word.wordString)
+            {
+                checksum ^= static_cast<uint8_t>(c);
+                checksum *= 1099511628211ULL;
+            }
+            checksum ^= '\n';
+            checksum *= 1099511628211ULL;
+        }
+
+        candidates = CandidateIndex(words);
+    }
+
+    CandidateIndex::CandidateIndex(const std::vector<WordUtils::Word> &words)
+    {
+        numRows = words.size();
+        Bits empty((numRows + 63) / 64, 0);
+        for (auto &position : atPosition)
+            position.fill(empty);
+        for (int c = 0; c < 26; ++c)
+        {
+            atLeast[c].fill(empty);
+            exactly[c].fill(empty);
+        }
+
+        for (size_t r = 0; r < numRows; ++r)
+        {
+            uint64_t bit = 1ULL << (r & 63);
+            size_t block = r >> 6;
+            const std::string &word = words[r].wordString;
+            std::array<int, 26> counts{};
+            for (int i = 0; i < 5; ++i)
+            {
+                int c = word[i] - 'a';
+                if (c < 0 || c >= 26)
+                    continue;
+                atPosition[i][c][block] |= bit;
+                counts[c]++;
+            }
+            for (int c = 0; c < 26; ++c)
+            {
+                exactly[c][counts[c]][block] |= bit;
+                for (int k = 0; k <= counts[c]; ++k)
+                {
+                    atLeast[c][k][block] |= bit;
+                }
+            }
+        }
+    }
+
+    bool CandidateIndex::filter(const std::vector<Feedback> &feedbacks, Bits &rows) const
+    {
+        rows.assign((numRows + 63) / 64, ~0ULL);
+        if (numRows % 64 != 0)
+            rows.back() = (1ULL << (numRows % 64)) - 1;
+
+        auto keep = [&rows](const Bits &set)
+        {
+            for (size_t b = 0; b < rows.size(); ++b)
+                rows[b] &= set[b];
+        };
+        auto drop = [&rows](const Bits &set)
+        {
+            for (size_t b = 0; b < rows.size(); ++b)
+                rows[b] &= ~set[b];
+        };
+
+        for (const auto &fb : feedbacks)
+        {
+            if (fb.word.size() != 5)
+                return false;
+            std::array<int, 5> letters;
+            for (int i = 0; i < 5; ++i)
+            {
+                letters[i] = fb.word[i] - 'a';
+                if (letters[i] < 0 || letters[i] >= 26)
+                    return false;
+            }
+
+            // Greens pin a letter, any other color rules it out at that position
+            for (int i = 0; i < 5; ++i)
+            {
+                if (fb.getColor(i) == 2)
+                    keep(atPosition[i][letters[i]]);
+                else
+                    drop(atPosition[i][letters[i]]);
+            }
+
+            // Per guessed letter: greens and yellows are copies found, a grey means there are no more
+            std::array<int, 26> found{};
+            std::array<bool, 26> capped{};
+            for (int i = 0; i < 5; ++i)
+            {
+                int c = letters[i];
+                int color = fb.getColor(i);
+                if (color == 0)
+                {
+                    capped[c] = true;
+                }
+                else
+                {
+                    // Yellows are given left to right, so no target can show one after a grey of the same letter
+                    if (color == 1 && capped[c])
+                    {
+                        std::fill(rows.begin(), rows.end(), 0);
+                        return true;
+                    }
+                    found[c]++;
+                }
+            }
+            for (int i = 0; i < 5; ++i)
+            {
+                int c = letters[i];
+                if (capped[c])
+                    keep(exactly[c][found[c]]);
+                else
+                    keep(atLeast[c][found[c]]);
+            }
+        }
+        return true;
+    }
+
+    int Lexicon::row(const WordUtils::Word &word) const
+    {
+        return row(word.index);
+    }
+
+    int Lexicon::row(int wordIndex) const
+    {
+        if (wordIndex < 0 || wordIndex >= static_cast<int>(rowOfIndex.size()))
+            return -1;
+        return rowOfIndex[wordIndex];
+    }
+
+    int Lexicon::row(const std::string &word) const
+    {
+        auto it = rowOfWord.find(word);
+        return (it == rowOfWord.end()) ? -1 : it->second;
+    }
+
     Feedback parseFeedback(const std::string &input)
     {
         Feedback fb;
         std::string word;
         std::string colors;
         size_t space = input.find(' ');
-        if (space == std::string::npos || space + 6 > input.size())
+        if (space == std::string::npos)
             throw std::runtime_error("Invalid feedback format");
         word = input.substr(0, space);
-        colors = input.substr(space + 1, 5);
-        if (word.size() != 5 || colors.size() != 5)
+        colors = input.substr(space + 1, word.size());
+        if (word.size() < MIN_WORD_LENGTH || word.size() > MAX_WORD_LENGTH || colors.size() != word.size())
             throw std::runtime_error("Word or colors wrong length");
         fb.word = WordUtils::trimToLower(word);
-        for (int i = 0; i < 5; ++i)
+        for (size_t i = 0; i < word.size(); ++i)
         {
             if (colors[i] < '0' || colors[i] > '2')
                 throw std::runtime_error("Invalid color digit");
@@ -41,95 +215,360 @@ namespace Wordle
         return fb;
     }
 
-    // Helper: Check if a word matches all feedback constraints
+    // Helper: Check if a word matches all feedback constraints, i.e. it would have produced this exact feedback
     bool matchesFeedback(const WordUtils::Word &candidate, const Feedback &fb)
     {
-        const std::string &guess = fb.word;
-        // Use pre-calculated letter count from candidate word
-        std::array<uint8_t, 26> candidateLetterCount = candidate.letterCount;
+        if (fb.word.size() != 5)
+            return candidate.wordString.size() == fb.word.size() && generateFeedbackCodeN(candidate, fb.word) == encodeFeedbackN(fb);
+        return generateFeedbackCode(candidate, fb.word) == encodeFeedback(fb);
+    }
+
+    // Generate feedback for a guess against a target word
+    Feedback generateFeedback(const WordUtils::Word &target, const std::string &guess)
+    {
+        if (guess.size() != 5)
+            return decodeFeedback(guess, generateFeedbackCodeN(target, guess));
+        return decodeFeedback(guess, generateFeedbackCode(target, guess));
+    }
+
+    uint8_t generateFeedbackCode(const WordUtils::Word &target, const std::string &guess)
+    {
+        std::array<uint8_t, 26> letterCount = target.letterCount;
+        std::array<uint8_t, 5> colors = {0, 0, 0, 0, 0};
 
-        // Check greens first, and adjust counts
+        // First pass: Mark greens and remove them from the available letters
         for (int i = 0; i < 5; ++i)
         {
-            if (fb.colors[i * 2 + 1]) // Green
-            {                         // Green
-                if (candidate.wordString[i] != guess[i])
-                {
-                    return false; // Must match green letters
-                }
-                candidateLetterCount[candidate.wordString[i] - 'a']--;
+            if (target.wordString[i] == guess[i])
+            {
+                colors[i] = 2;
+                letterCount[target.wordString[i] - 'a']--;
             }
         }
 
+        // Second pass: Mark yellows left to right while letters remain
         for (int i = 0; i < 5; ++i)
         {
-            char guessChar = guess[i];
-            if (fb.colors[i * 2 + 1])
-            { // Green (already checked)
-                continue;
-            }
-            else if (fb.colors[i * 2])
-            { // Yellow
-                if (candidate.wordString[i] == guessChar)
-                {
-                    return false; // Yellow letter cannot be in the same spot
-                }
-                if (candidateLetterCount[guessChar - 'a'] <= 0)
-                {
-                    return false; // Must contain the yellow letter elsewhere
-                }
-                candidateLetterCount[guessChar - 'a']--;
-            }
-            else
-            { // Grey
-                if (candidateLetterCount[guessChar - 'a'] > 0)
+            if (colors[i] == 0)
+            {
+                int guessCharIndex = guess[i] - 'a';
+                if (letterCount[guessCharIndex] > 0)
                 {
-                    return false; // Candidate has a letter that was marked grey
+                    colors[i] = 1;
+                    letterCount[guessCharIndex]--;
                 }
             }
         }
 
-        return true;
+        uint8_t code = 0;
+        for (int i = 0; i < 5; ++i)
+        {
+            code += colors[i] * FEEDBACK_POWERS[i];
+        }
+        return code;
     }
 
-    // Generate feedback for a guess against a target word
-    Feedback generateFeedback(const WordUtils::Word &target, const std::string &guess)
+    uint8_t encodeFeedback(const Feedback &fb)
+    {
+        uint8_t code = 0;
+        for (int i = 0; i < 5; ++i)
+        {
+            code += fb.getColor(i) * FEEDBACK_POWERS[i];
+        }
+        return code;
+    }
+
+    Feedback decodeFeedback(const std::string &guess, int code)
     {
         Feedback fb;
         fb.word = guess;
+        for (size_t i = 0; i < guess.size(); ++i)
+        {
+            int color = code % 3;
+            code /= 3;
+            if (color == 2)
+                fb.setGreen(i);
+            else if (color == 1)
+                fb.setYellow(i);
+        }
+        return fb;
+    }
 
-        // The bitset is already initialized to all zeros (all grey)
+    // Same two passes as generateFeedbackCode, over a length known at compile time
+    template <int Length>
+    uint16_t generateFeedbackCodeN(const WordUtils::Word &target, const std::string &guess)
+    {
         std::array<uint8_t, 26> letterCount = target.letterCount;
+        std::array<uint8_t, Length> colors{};
+        const char *t = target.wordString.data();
+        const char *g = guess.data();
 
-        // First pass: Mark greens. A green is represented by setting both bits for a position to 1.
-        // Example for position i: bit (i*2) = 1, bit (i*2 + 1) = 1.
-        for (int i = 0; i < 5; ++i)
+        for (int i = 0; i < Length; ++i)
         {
-            if (target.wordString[i] == guess[i])
+            if (t[i] == g[i])
+            {
+                colors[i] = 2;
+                letterCount[t[i] - 'a']--;
+            }
+        }
+        for (int i = 0; i < Length; ++i)
+        {
+            if (colors[i] == 0 && letterCount[g[i] - 'a'] > 0)
             {
-                // Direct manipulation: Set the 'green' bit and the 'yellow' bit.
-                fb.colors[i * 2 + 1] = 1; // This bit signals "correct position" (Green).
-                fb.colors[i * 2] = 1;     // This bit signals "in word" (Green or Yellow).
+                colors[i] = 1;
+                letterCount[g[i] - 'a']--;
+            }
+        }
 
-                letterCount[target.wordString[i] - 'a']--;
+        uint16_t code = 0;
+        for (int i = Length - 1; i >= 0; --i)
+        {
+            code = code * 3 + colors[i];
+        }
+        return code;
+    }
+
+    template uint16_t generateFeedbackCodeN<4>(const WordUtils::Word &, const std::string &);
+    template uint16_t generateFeedbackCodeN<5>(const WordUtils::Word &, const std::string &);
+    template uint16_t generateFeedbackCodeN<6>(const WordUtils::Word &, const std::string &);
+    template uint16_t generateFeedbackCodeN<7>(const WordUtils::Word &, const std::string &);
+    template uint16_t generateFeedbackCodeN<8>(const WordUtils::Word &, const std::string &);
+
+    int generateFeedbackCodeN(const WordUtils::Word &target, const std::string &guess)
+    {
+        switch (guess.size())
+        {
+        case 4:
+            return generateFeedbackCodeN<4>(target, guess);
+        case 5:
+            return generateFeedbackCodeN<5>(target, guess);
+        case 6:
+            return generateFeedbackCodeN<6>(target, guess);
+        case 7:
+            return generateFeedbackCodeN<7>(target, guess);
+        case 8:
+            return generateFeedbackCodeN<8>(target, guess);
+        default:
+            throw std::runtime_error("Unsupported word length " + std::to_string(guess.size()));
+        }
+    }
+
+    int encodeFeedbackN(const Feedback &fb)
+    {
+        int code = 0;
+        for (int i = static_cast<int>(fb.word.size()) - 1; i >= 0; --i)
+        {
+            code = code * 3 + fb.getColor(i);
+        }
+        return code;
+    }
+
+    TargetBlock::TargetBlock(const std::vector<WordUtils::Word> &targets)
+    {
+        count = targets.size();
+        size_t padded = (count + 31) / 32 * 32;
+        for (int i = 0; i < 5; ++i)
+        {
+            letters[i].assign(padded, 0);
+        }
+        for (size_t t = 0; t < count; ++t)
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                letters[i][t] = static_cast<uint8_t>(targets[t].wordString[i]);
             }
         }
+    }
+
+    // Lane operations for the batched kernel. Masks are all-ones bytes, so subtracting a mask counts it.
+#if defined(__AVX2__)
+    struct FeedbackLanes
+    {
+        using Vec = __m256i;
+        static const int width = 32;
+        static Vec load(const uint8_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(uint8_t *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+        static Vec splat(uint8_t x) { return _mm256_set1_epi8(static_cast<char>(x)); }
+        static Vec equal(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+        static Vec greater(Vec a, Vec b) { return _mm256_cmpgt_epi8(a, b); }
+        static Vec andNot(Vec mask, Vec v) { return _mm256_andnot_si256(mask, v); }
+        static Vec select(Vec mask, Vec v) { return _mm256_and_si256(mask, v); }
+        static Vec add(Vec a, Vec b) { return _mm256_add_epi8(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_epi8(a, b); }
+    };
+#elif defined(__SSE2__) || defined(_M_X64)
+    struct FeedbackLanes
+    {
+        using Vec = __m128i;
+        static const int width = 16;
+        static Vec load(const uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+        static void store(uint8_t *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+        static Vec splat(uint8_t x) { return _mm_set1_epi8(static_cast<char>(x)); }
+        static Vec equal(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+        static Vec greater(Vec a, Vec b) { return _mm_cmpgt_epi8(a, b); }
+        static Vec andNot(Vec mask, Vec v) { return _mm_andnot_si128(mask, v); }
+        static Vec select(Vec mask, Vec v) { return _mm_and_si128(mask, v); }
+        static Vec add(Vec a, Vec b) { return _mm_add_epi8(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm_sub_epi8(a, b); }
+    };
+#else
+    struct FeedbackLanes
+    {
+        using Vec = uint8_t;
+        static const int width = 1;
+        static void store(uint8_t *p, Vec v) { *p = v; }
+    };
+#endif
+
+    // Codes of FeedbackLanes::width targets starting at offset. Position i is yellow when it isn't green
+    // and the target has more non-green copies of the letter than earlier non-green positions of the
+    // guess already claimed, which matches the left to right yellow marking of generateFeedbackCode.
+    FeedbackLanes::Vec feedbackLanes(const std::string &guess, const TargetBlock &targets, size_t offset)
+    {
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+        using L = FeedbackLanes;
+        L::Vec target[5], green[5];
+        for (int i = 0; i < 5; ++i)
+        {
+            target[i] = L::load(targets.letters[i].data() + offset);
+            green[i] = L::equal(target[i], L::splat(static_cast<uint8_t>(guess[i])));
+        }
 
-        // Second pass: Mark yellows. A yellow is when the "in word" bit is 1 but "correct position" is 0.
+        L::Vec code = L::splat(0);
         for (int i = 0; i < 5; ++i)
         {
-            if (!fb.colors[i * 2 + 1]) // If it's NOT green...
+            L::Vec letter = L::splat(static_cast<uint8_t>(guess[i]));
+            L::Vec available = L::splat(0);
+            L::Vec claimed = L::splat(0);
+            for (int j = 0; j < 5; ++j)
             {
-                int guessCharIndex = guess[i] - 'a';
-                if (letterCount[guessCharIndex] > 0)
-                {
-                    fb.colors[i * 2] = 1;
-                    letterCount[guessCharIndex]--;
-                }
+                available = L::sub(available, L::andNot(green[j], L::equal(target[j], letter)));
+                if (j < i && guess[j] == guess[i])
+                    claimed = L::sub(claimed, L::andNot(green[j], L::splat(0xFF)));
+            }
+            L::Vec yellow = L::andNot(green[i], L::greater(available, claimed));
+            code = L::add(code, L::select(green[i], L::splat(2 * FEEDBACK_POWERS[i])));
+            code = L::add(code, L::select(yellow, L::splat(FEEDBACK_POWERS[i])));
+        }
+        return code;
+#else
+        // Scalar fallback, one target per call: greens first, then yellows left to right while letters remain
+        uint8_t remaining[26] = {};
+        bool green[5];
+        uint8_t code = 0;
+        for (int i = 0; i < 5; ++i)
+        {
+            uint8_t letter = targets.letters[i][offset];
+            green[i] = letter == static_cast<uint8_t>(guess[i]);
+            if (green[i])
+                code += 2 * FEEDBACK_POWERS[i];
+            else if (letter != 0)
+                remaining[letter - 'a']++;
+        }
+        for (int i = 0; i < 5; ++i)
+        {
+            if (!green[i] && remaining[guess[i] - 'a'] > 0)
+            {
+                code += FEEDBACK_POWERS[i];
+                remaining[guess[i] - 'a']--;
             }
         }
+        return code;
+#endif
+    }
 
-        return fb;
+    void generateFeedbackCodes(const std::string &guess, const TargetBlock &targets, uint8_t *codes)
+    {
+        const size_t width = FeedbackLanes::width;
+        size_t t = 0;
+        for (; t + width <= targets.count; t += width)
+        {
+            FeedbackLanes::store(codes + t, feedbackLanes(guess, targets, t));
+        }
+        if (t < targets.count)
+        {
+            // Rows are padded, so the last partial group is computed in full and only the real targets are copied
+            uint8_t tail[32];
+            FeedbackLanes::store(tail, feedbackLanes(guess, targets, t));
+            std::memcpy(codes + t, tail, targets.count - t);
+        }
+    }
+
+    void countFeedbackCodes(const std::string &guess, const TargetBlock &targets,
+                            std::array<int, NUM_FEEDBACK_CODES> &counts)
+    {
+        const size_t width = FeedbackLanes::width;
+        uint8_t codes[32];
+        for (size_t t = 0; t < targets.count; t += width)
+        {
+            FeedbackLanes::store(codes, feedbackLanes(guess, targets, t));
+            size_t lanes = std::min(width, targets.count - t);
+            for (size_t k = 0; k < lanes; ++k)
+            {
+                counts[codes[k]]++;
+            }
+        }
+    }
+
+    // Loads data/feedback_matrix.bin if it matches the corpus, otherwise builds it and saves it for next time.
+    FeedbackMatrix loadFeedbackMatrix(const std::vector<WordUtils::Word> &allWords)
+    {
+        FeedbackMatrix matrix;
+        matrix.lexicon = Lexicon(allWords);
+
+        uint64_t n = matrix.lexicon.size();
+        uint64_t checksum = matrix.lexicon.checksum;
+        size_t headerSize = sizeof(FEEDBACK_MATRIX_MAGIC) + sizeof(n) + sizeof(checksum);
+        matrix.headerSize = headerSize;
+
+        std::filesystem::path data_dir = std::filesystem::current_path() / "data";
+        std::filesystem::path matrixPath = data_dir / "feedback_matrix.bin";
+
+        if (matrix.file.open(matrixPath))
+        {
+            const uint8_t *header = matrix.file.data();
+            bool valid = matrix.file.size() == headerSize + n * n &&
+                         std::memcmp(header, FEEDBACK_MATRIX_MAGIC, sizeof(FEEDBACK_MATRIX_MAGIC)) == 0 &&
+                         std::memcmp(header + sizeof(FEEDBACK_MATRIX_MAGIC), &n, sizeof(n)) == 0 &&
+                         std::memcmp(header + sizeof(FEEDBACK_MATRIX_MAGIC) + sizeof(n), &checksum, sizeof(checksum)) == 0;
+            if (valid)
+                return matrix;
+            matrix.file.close();
+        }
+
+        // Build every guess row against every target
+        std::cerr << "Building Wordle feedback matrix for " << n << " words...\n";
+        matrix.buffer.resize(n * n);
+        const std::vector<WordUtils::Word> &words = matrix.lexicon.words;
+        TargetBlock targets(words);
+        for (size_t g = 0; g < n; ++g)
+        {
+            generateFeedbackCodes(words[g].wordString, targets, matrix.buffer.data() + g * n);
+        }
+
+        // Save to binary for next time, then map it so the pages are shared and the buffer can be released
+        std::filesystem::path tempPath = data_dir / "feedback_matrix.bin.tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary);
+            out.write(FEEDBACK_MATRIX_MAGIC, sizeof(FEEDBACK_MATRIX_MAGIC));
+            out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+            out.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+            out.write(reinterpret_cast<const char *>(matrix.buffer.data()), matrix.buffer.size());
+            if (!out)
+                return matrix;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, matrixPath, ec);
+        if (!ec && matrix.file.open(matrixPath) && matrix.file.size() == headerSize + n * n)
+        {
+            std::vector<uint8_t>().swap(matrix.buffer);
+        }
+        else
+        {
+            matrix.file.close();
+        }
+        return matrix;
     }
 
     // Calculate information bits
@@ -147,39 +586,138 @@ namespace Wordle
         if (possibleWords.empty())
             return 0.0;
 
-        std::unordered_map<unsigned long, int> feedbackCounts;
+        std::array<int, NUM_FEEDBACK_CODES> feedbackCounts{};
 
-        // For each possible target word, generate feedback and count
-        for (const auto &target : possibleWords)
-        {
-            Feedback fb = generateFeedback(target, guess.wordString);
-            feedbackCounts[fb.colors.to_ulong()]++;
-        }
+        // Generate feedback against every possible target word and count
+        countFeedbackCodes(guess.wordString, TargetBlock(possibleWords), feedbackCounts);
 
         // Calculate entropy
         double entropy = 0.0;
         int totalWords = possibleWords.size();
 
-        for (const auto &pair : feedbackCounts)
+        for (int count : feedbackCounts)
         {
-            double probability = static_cast<double>(pair.second) / totalWords;
+            if (count == 0)
+                continue;
+            double probability = static_cast<double>(count) / totalWords;
             entropy += probability * bits(probability);
         }
 
         return entropy;
     }
 
+    // --- Hard mode ---
+    HardModeRule::HardModeRule(const std::vector<Feedback> &feedbacks)
+    {
+        for (const auto &fb : feedbacks)
+        {
+            add(fb);
+        }
+    }
+
+    void HardModeRule::add(const Feedback &fb)
+    {
+        std::array<uint8_t, 26> revealed{};
+        for (size_t i = 0; i < fb.word.size() && i < greens.size(); ++i)
+        {
+            int color = fb.getColor(static_cast<int>(i));
+            if (color == 2)
+                greens[i] = fb.word[i];
+            if (color > 0)
+                revealed[fb.word[i] - 'a']++;
+        }
+        for (int c = 0; c < 26; ++c)
+        {
+            required[c] = std::max(required[c], revealed[c]);
+        }
+    }
+
+    bool HardModeRule::allows(const WordUtils::Word &word) const
+    {
+        for (size_t i = 0; i < word.wordString.size() && i < greens.size(); ++i)
+        {
+            if (greens[i] != 0 && word.wordString[i] != greens[i])
+                return false;
+        }
+        for (int c = 0; c < 26; ++c)
+        {
+            if (word.letterCount[c] < required[c])
+                return false;
+        }
+        return true;
+    }
+
+    uint64_t HardModeRule::hash() const
+    {
+        uint64_t h = 1469598103934665603ULL;
+        for (char c : greens)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 1099511628211ULL;
+        }
+        for (uint8_t count : required)
+        {
+            h ^= count;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    std::vector<WordUtils::Word> hardModeGuesses(const std::vector<WordUtils::Word> &words, const HardModeRule &rule)
+    {
+        std::vector<WordUtils::Word> allowed;
+        for (const auto &word : words)
+        {
+            if (rule.allows(word))
+                allowed.push_back(word);
+        }
+        return allowed;
+    }
+
     std::vector<WordUtils::Word> filterWords(
         const std::vector<WordUtils::Word> &words,
-        const std::vector<Feedback> &feedbacks)
+        const std::vector<Feedback> &feedbacks,
+        const FeedbackMatrix *feedbackMatrix)
     {
+        // With the corpus index, the whole history reduces to one bitset of lexicon rows
+        const Lexicon *lexicon = feedbackMatrix ? &feedbackMatrix->lexicon : nullptr;
+        CandidateIndex::Bits candidateRows;
+        if (lexicon && !feedbacks.empty() && lexicon->candidates.filter(feedbacks, candidateRows))
+        {
+            std::vector<WordUtils::Word> filtered;
+            for (const auto &w : words)
+            {
+                int wordRow = lexicon->row(w);
+                bool ok = (wordRow >= 0) ? CandidateIndex::test(candidateRows, wordRow)
+                                         : std::all_of(feedbacks.begin(), feedbacks.end(), [&w](const Feedback &fb)
+                                                       { return matchesFeedback(w, fb); });
+                if (ok)
+                    filtered.push_back(w);
+            }
+            return filtered;
+        }
+
+        // Resolve each feedback to a matrix row once so words can be checked with a single lookup
+        std::vector<const uint8_t *> feedbackRows;
+        std::vector<uint8_t> feedbackCodes;
+        for (const auto &fb : feedbacks)
+        {
+            int guessRow = feedbackMatrix ? feedbackMatrix->lexicon.row(fb.word) : -1;
+            feedbackRows.push_back(guessRow >= 0 ? feedbackMatrix->row(guessRow) : nullptr);
+            feedbackCodes.push_back(encodeFeedback(fb));
+        }
+
         std::vector<WordUtils::Word> filtered;
         for (const auto &w : words)
         {
+            int wordRow = feedbackMatrix ? feedbackMatrix->lexicon.row(w) : -1;
             bool ok = true;
-            for (const auto &fb : feedbacks)
+            for (size_t i = 0; i < feedbacks.size(); ++i)
             {
-                if (!matchesFeedback(w, fb))
+                bool matches = (feedbackRows[i] && wordRow >= 0)
+                                   ? feedbackRows[i][wordRow] == feedbackCodes[i]
+                                   : matchesFeedback(w, feedbacks[i]);
+                if (!matches)
                 {
                     ok = false;
                     break;
@@ -191,168 +729,2074 @@ namespace Wordle
         return filtered;
     }
 
-    // Calculate best guesses sorted by information value with multi-depth entropy
-    std::vector<WordGuess> calculateBestGuesses(
-        const std::vector<WordUtils::Word> &fiveLetterWords,
-        const std::vector<WordUtils::Word> &possibleWords,
-        const std::vector<Feedback> &feedbackHistory,
-        const Config &config,
-        int recursionLevel)
+    // Everything shared by the guesses scored at one node of the search
+    struct SearchNode
     {
-        std::vector<WordGuess> guesses;
-
-        // Create a set for fast O(1) lookups.
+        const std::vector<WordUtils::Word> &fiveLetterWords;
+        const std::vector<WordUtils::Word> &possibleWords;
+        const std::vector<Feedback> &feedbackHistory;
+        const Config &config;
+        int recursionLevel;
+        std::vector<int> targetRows; // Matrix rows of the targets, empty if the matrix can't be used
         std::unordered_set<std::string> possibleWordSet;
-        for (const auto &w : possibleWords)
-        {
-            possibleWordSet.insert(w.wordString);
-        }
+        TargetBlock targets; // Targets for the batched kernel, only built when targetRows is empty
+        std::vector<int> sample; // Sampled target indices, ascending, the levels past the first are exact if empty
+        const HardModeRule *hardModeRule = nullptr; // Rule the guesses were narrowed by, null outside hard mode
+    };
 
-        // Calculate entropy for each potential guess
-        for (const auto &word : fiveLetterWords)
-        {
-            WordGuess guess;
-            guess.word = word;
+    // Per-worker buffers reused across the guesses a worker scores
+    struct ScoringScratch
+    {
+        std::array<int, NUM_FEEDBACK_CODES> feedbackCounts{}; // All zero between guesses
+        std::array<int, NUM_FEEDBACK_CODES> bucketStart;      // Offset of each code's bucket in partition
+        std::vector<uint8_t> usedCodes;                       // Codes with a non-zero count, ascending
+        std::vector<uint8_t> codes;                           // Feedback code of each target
+        std::vector<uint8_t> batchCodes;                      // Kernel output when there is no matrix row
+        std::vector<int> partition;                           // Target indices grouped by feedback code
+        std::vector<uint8_t> signature;                       // Canonical partition of the targets by one guess
+        std::array<int, NUM_FEEDBACK_CODES> childSlot;        // Index in children of each searched bucket, or -1
+        std::vector<WordGuess> children;                      // Best guess of each bucket searched for the sample
+    };
+
+    // Score one guess at a search node to the given depth, searching the feedback buckets for the levels
+    // past the first. upperBounds (if given) receives a bound on every level up to config.maxDepth:
+    // a child search can't gain more than log2 of its bucket size, nor more than log2(243) per move.
+    WordGuess scoreGuess(const SearchNode &node, const WordUtils::Word &word, ScoringScratch &scratch,
+                         int depth, std::vector<double> *upperBounds = nullptr)
+    {
+        const std::vector<WordUtils::Word> &possibleWords = node.possibleWords;
+        const Config &config = node.config;
+        const FeedbackMatrix *matrix = config.feedbackMatrix;
+
+        WordGuess guess;
+        guess.wordIndex = word.index;
+
+        // Initialize entropy levels
+        Levels entropyList;
+        entropyList.resize(config.maxDepth, 0.0);
+        double firstLevelEntropy = 0.0;
+
+        // Generate all possible feedback patterns for this guess
+        int guessRow = node.targetRows.empty() ? -1 : matrix->lexicon.row(word);
+        const uint8_t *guessCodes = (guessRow >= 0) ? matrix->row(guessRow) : nullptr;
+        if (guessCodes == nullptr)
+        {
+            // Without a matrix row, compute the codes in one batch. The targets are only laid out for
+            // the kernel when the matrix can't be used at all, a lone unknown guess is done per target.
+            scratch.batchCodes.resize(possibleWords.size());
+            if (node.targets.count == possibleWords.size())
+            {
+                generateFeedbackCodes(word.wordString, node.targets, scratch.batchCodes.data());
+            }
+            else
+            {
+                for (size_t t = 0; t < possibleWords.size(); ++t)
+                {
+                    scratch.batchCodes[t] = generateFeedbackCode(possibleWords[t], word.wordString);
+                }
+            }
+            guessCodes = scratch.batchCodes.data();
+        }
+
+        // Count targets per feedback code, remembering which codes occur so the work stays
+        // proportional to the number of targets rather than the 243 possible codes.
+        // Codes per target are only kept when a deeper level needs the targets partitioned.
+        std::array<int, NUM_FEEDBACK_CODES> &feedbackCounts = scratch.feedbackCounts;
+        std::vector<uint8_t> &usedCodes = scratch.usedCodes;
+        uint8_t *codes = nullptr;
+        bool expand = depth > 1;
+        if (expand)
+        {
+            scratch.codes.resize(possibleWords.size());
+            codes = scratch.codes.data();
+        }
+        usedCodes.clear();
+        for (size_t t = 0; t < possibleWords.size(); ++t)
+        {
+            uint8_t code = (guessRow >= 0) ? guessCodes[node.targetRows[t]] : guessCodes[t];
+            if (feedbackCounts[code]++ == 0)
+                usedCodes.push_back(code);
+            if (codes)
+                codes[t] = code;
+        }
+        std::sort(usedCodes.begin(), usedCodes.end());
+
+        // Group the targets by feedback code once, each bucket is the candidate set of a child search
+        std::array<int, NUM_FEEDBACK_CODES> &bucketStart = scratch.bucketStart;
+        if (codes)
+        {
+            int start = 0;
+            for (uint8_t code : usedCodes)
+            {
+                bucketStart[code] = start;
+                start += feedbackCounts[code];
+            }
+            scratch.partition.resize(possibleWords.size());
+            for (size_t t = 0; t < possibleWords.size(); ++t)
+            {
+                scratch.partition[bucketStart[codes[t]]++] = static_cast<int>(t);
+            }
+            for (uint8_t code : usedCodes)
+            {
+                bucketStart[code] -= feedbackCounts[code];
+            }
+        }
+
+        if (upperBounds)
+            upperBounds->assign(config.maxDepth, 0.0);
+
+        // Best guesses for the words left after a feedback, which are exactly this guess's bucket
+        auto searchBucket = [&](uint8_t code, int count)
+        {
+            std::vector<WordUtils::Word> filteredWords;
+            filteredWords.reserve(count);
+            for (int k = bucketStart[code]; k < bucketStart[code] + count; ++k)
+            {
+                filteredWords.push_back(possibleWords[scratch.partition[k]]);
+            }
+
+            // Recursively calculate best guess for deeper levels
+            Config nextConfig = config;
+            nextConfig.maxDepth = depth - 1;
+
+            // In hard mode the child's guesses must also use what this feedback reveals
+            HardModeRule childRule;
+            if (node.hardModeRule != nullptr)
+            {
+                childRule = *node.hardModeRule;
+                childRule.add(decodeFeedback(word.wordString, code));
+                nextConfig.hardModeRule = &childRule;
+            }
+
+            return calculateBestGuesses(
+                node.fiveLetterWords, filteredWords, node.feedbackHistory, nextConfig, node.recursionLevel + 1);
+        };
+
+        // Sampling error of each level, as the variance of the estimate
+        std::vector<double> variance(config.maxDepth, 0.0);
+
+        // A sampled node estimates the levels past the first from its sampled targets. Level i + 1 is
+        // log2(n) less the expected uncertainty left after it: log2 of the target's bucket size less the
+        // entropy of the bucket's best guess. That residual is 0 for buckets of one or two words, which
+        // need no search, and small for other small buckets, so its mean has a much lower variance than
+        // the child entropies themselves. Each bucket is searched once, however many targets fall in it.
+        if (expand && !node.sample.empty())
+        {
+            double m = static_cast<double>(node.sample.size());
+            std::vector<double> residualSum(depth, 0.0);
+            std::vector<double> residualSquares(depth, 0.0);
+            std::vector<double> childVariance(depth, 0.0);
+            scratch.childSlot.fill(-1);
+            scratch.children.clear();
+            for (int t : node.sample)
+            {
+                uint8_t code = codes[t];
+                int count = feedbackCounts[code];
+                if (count <= 2)
+                    continue;
+
+                if (scratch.childSlot[code] < 0)
+                {
+                    if (config.deadline && config.deadline->expired())
+                        break;
+                    std::vector<WordGuess> nextBestGuesses = searchBucket(code, count);
+                    scratch.childSlot[code] = static_cast<int>(scratch.children.size());
+                    scratch.children.push_back(nextBestGuesses.empty() ? WordGuess{} : nextBestGuesses[0]);
+                }
+
+                const WordGuess &bestNextGuess = scratch.children[scratch.childSlot[code]];
+                for (size_t i = 0; i + 1 < static_cast<size_t>(depth); i++)
+                {
+                    double childEntropy = (i < bestNextGuess.entropyList.size()) ? bestNextGuess.entropyList[i] : 0.0;
+                    double residual = std::max(std::log2(count) - childEntropy, 0.0);
+                    residualSum[i + 1] += residual;
+                    residualSquares[i + 1] += residual * residual;
+                    double childMargin = (i < bestNextGuess.confidenceList.size()) ? bestNextGuess.confidenceList[i] : 0.0;
+                    childVariance[i + 1] += childMargin * childMargin;
+                }
+            }
+
+            // Sampled without replacement, so the variance of the mean shrinks to 0 as m approaches n
+            double n = static_cast<double>(possibleWords.size());
+            double populationCorrection = (n - m) / (n - 1.0);
+            for (int i = 1; i < depth; i++)
+            {
+                double mean = residualSum[i] / m;
+                double sampleVariance = (m > 1) ? std::max(residualSquares[i] - m * mean * mean, 0.0) / (m - 1) : 0.0;
+                entropyList[i] = std::log2(n) - mean;
+                variance[i] = sampleVariance / m * populationCorrection + childVariance[i] / (m * m);
+            }
+        }
+
+        // Calculate first level entropy and prepare for deeper levels
+        for (uint8_t code : usedCodes)
+        {
+            int count = feedbackCounts[code];
+            feedbackCounts[code] = 0; // Leave the scratch counts zeroed for the next guess
+            double probability = static_cast<double>(count) / possibleWords.size();
+            double info = bits(probability);
+
+            firstLevelEntropy += probability * info;
+
+            if (upperBounds && count > 1)
+            {
+                for (int i = 1; i < config.maxDepth; i++)
+                {
+                    (*upperBounds)[i] += probability * std::min(std::log2(count), i * std::log2(NUM_FEEDBACK_CODES));
+                }
+            }
+
+            // Calculate deeper entropy, unless the search is out of time and the result will be dropped
+            if (expand && node.sample.empty() && !(config.deadline && config.deadline->expired()))
+            {
+                std::vector<WordGuess> nextBestGuesses = searchBucket(code, count);
+                if (!nextBestGuesses.empty())
+                {
+                    const WordGuess &bestNextGuess = nextBestGuesses[0];
+                    for (size_t i = 0; i + 1 < static_cast<size_t>(depth) && i < bestNextGuess.entropyList.size(); i++)
+                    {
+                        double additionalEntropy = -bits(possibleWords.size()) +
+                                                   (bits(count) + bestNextGuess.entropyList[i]);
+                        entropyList[i + 1] += probability * additionalEntropy;
+                    }
+                    for (size_t i = 0; i + 1 < static_cast<size_t>(depth) && i < bestNextGuess.confidenceList.size(); i++)
+                    {
+                        double margin = probability * bestNextGuess.confidenceList[i];
+                        variance[i + 1] += margin * margin;
+                    }
+                }
+            }
+        }
+
+        entropyList[0] = firstLevelEntropy;
+        guess.entropy = firstLevelEntropy;
+        guess.entropyList = entropyList;
+        guess.scoredDepth = depth;
+
+        // The first level is always exact, confidence is only reported once a level below was estimated
+        bool estimated = expand && (!node.sample.empty() || std::any_of(variance.begin(), variance.end(), [](double v)
+                                                                        { return v > 0.0; }));
+        if (estimated)
+        {
+            guess.confidenceList.resize(config.maxDepth, 0.0);
+            for (int i = 1; i < depth; i++)
+            {
+                guess.confidenceList[i] = 1.96 * std::sqrt(variance[i]);
+            }
+        }
+
+        if (upperBounds)
+        {
+            for (double &bound : *upperBounds)
+            {
+                bound += firstLevelEntropy;
+            }
+        }
+
+        // Calculate probability of this word being the answer
+        bool isPossible = node.possibleWordSet.count(word.wordString);
+        guess.probability = isPossible ? (1.0 / possibleWords.size()) : 0.0;
+
+        return guess;
+    }
+
+    // Whether a guess, whose levels past the first are bounded by upperBounds, could rank ahead of other
+    // once both are scored to depth. Levels are compared deepest first; a bound within tolerance of
+    // other may still tie, so the decision falls through to the next level.
+    bool canRankAhead(const std::vector<double> &upperBounds, int depth, const WordGuess &guess, const WordGuess &other)
+    {
+        const double tolerance = 1e-9;
+        for (int i = depth - 1; i >= 1; i--)
+        {
+            double otherEntropy = (static_cast<size_t>(i) < other.entropyList.size()) ? other.entropyList[i] : 0.0;
+            if (upperBounds[i] > otherEntropy + tolerance)
+                return true;
+            if (upperBounds[i] < otherEntropy - tolerance)
+                return false;
+        }
+
+        // The first level is exact
+        double otherEntropy = other.entropyList.empty() ? 0.0 : other.entropyList[0];
+        if (std::abs(guess.entropy - otherEntropy) > tolerance)
+            return guess.entropy > otherEntropy;
+        if (std::abs(guess.probability - other.probability) > tolerance)
+            return guess.probability > other.probability;
+        return guess.wordIndex < other.wordIndex;
+    }
+
+    // Write the partition of the node's targets by a guess to signature, as the bucket of each target with
+    // buckets numbered in order of first appearance, so guesses splitting the targets the same way get the
+    // same signature whatever their feedback codes. Returns a hash of it.
+    uint64_t partitionSignature(const SearchNode &node, const WordUtils::Word &word, std::vector<uint8_t> &signature)
+    {
+        const std::vector<WordUtils::Word> &possibleWords = node.possibleWords;
+        const FeedbackMatrix *matrix = node.config.feedbackMatrix;
+
+        signature.resize(possibleWords.size());
+        int guessRow = node.targetRows.empty() ? -1 : matrix->lexicon.row(word);
+        if (guessRow >= 0)
+        {
+            const uint8_t *guessCodes = matrix->row(guessRow);
+            for (size_t t = 0; t < possibleWords.size(); ++t)
+            {
+                signature[t] = guessCodes[node.targetRows[t]];
+            }
+        }
+        else if (node.targets.count == possibleWords.size())
+        {
+            generateFeedbackCodes(word.wordString, node.targets, signature.data());
+        }
+        else
+        {
+            for (size_t t = 0; t < possibleWords.size(); ++t)
+            {
+                signature[t] = generateFeedbackCode(possibleWords[t], word.wordString);
+            }
+        }
+
+        // Renumber the buckets, there are at most 243 so the numbers still fit in a byte
+        std::array<int, NUM_FEEDBACK_CODES> bucket;
+        bucket.fill(-1);
+        int numBuckets = 0;
+        uint64_t hash = 1469598103934665603ULL;
+        for (uint8_t &code : signature)
+        {
+            if (bucket[code] < 0)
+                bucket[code] = numBuckets++;
+            code = static_cast<uint8_t>(bucket[code]);
+            hash ^= code;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
 
-            // Initialize entropy levels
-            std::vector<double> entropyList(config.maxDepth, 0.0);
-            double firstLevelEntropy = 0.0;
+    // Calculate best guesses sorted by information value with multi-depth entropy
+    std::vector<WordGuess> calculateBestGuesses(
+        const std::vector<WordUtils::Word> &guessWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const std::vector<Feedback> &feedbackHistory,
+        const Config &config,
+        int recursionLevel)
+    {
+        if (config.maxDepth > MAX_SEARCH_DEPTH)
+            throw std::runtime_error("Search depth " + std::to_string(config.maxDepth) + " is deeper than the supported " +
+                                     std::to_string(MAX_SEARCH_DEPTH));
+
+        // A hard mode search starts from the rule of its history, child searches are handed theirs
+        HardModeRule historyRule;
+        const HardModeRule *rule = config.hardModeRule;
+        if (config.hardMode && rule == nullptr)
+        {
+            historyRule = HardModeRule(feedbackHistory);
+            rule = &historyRule;
+        }
+
+        // Child searches depend only on the candidate set and the remaining depth, so identical
+        // buckets reached through different guesses are answered from the cache
+        CacheUtils::TranspositionCache<WordGuess> *cache = (recursionLevel > 0) ? config.cache : nullptr;
+        bool sample = config.sampleSize > 0 && config.maxDepth > 1 &&
+                      possibleWords.size() > static_cast<size_t>(std::max(config.sampleSize, config.sampleAbove));
+        uint64_t fingerprint = 0;
+        if (cache != nullptr || sample)
+        {
+            std::vector<int> ids;
+            ids.reserve(possibleWords.size());
+            for (const auto &w : possibleWords)
+            {
+                if (w.index < 0)
+                {
+                    ids.clear();
+                    cache = nullptr;
+                    break;
+                }
+                ids.push_back(w.index);
+            }
+            if (!ids.empty())
+                fingerprint = CacheUtils::fingerprint(ids);
+
+            // In hard mode the guesses depend on the path as well as the candidates
+            if (rule != nullptr)
+                fingerprint ^= rule->hash() * 0x9E3779B97F4A7C15ULL;
+            WordGuess cached;
+            if (cache != nullptr && cache->find(fingerprint, config.maxDepth, cached))
+                return {cached};
+        }
+
+        // Hard mode scores only the guesses the rule allows. A child's rule only adds to its parent's, so
+        // narrowing the parent's guesses is enough.
+        std::vector<WordUtils::Word> allowedWords;
+        if (rule != nullptr)
+            allowedWords = hardModeGuesses(guessWords, *rule);
+        const std::vector<WordUtils::Word> &fiveLetterWords = (rule != nullptr) ? allowedWords : guessWords;
+
+        SearchNode node{fiveLetterWords, possibleWords, feedbackHistory, config, recursionLevel, {}, {}, {}, {}};
+        node.hardModeRule = rule;
+
+        // Every guess at a node is estimated from the same sample, so their differences are measured
+        // more precisely than their levels. The sample is seeded by the candidate set rather than drawn
+        // in search order, so results don't depend on scheduling and a cached one matches a fresh search.
+        if (sample)
+        {
+            std::vector<int> order(possibleWords.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::mt19937_64 rng(static_cast<uint64_t>(config.sampleSeed) ^ fingerprint);
+            for (int i = 0; i < config.sampleSize; ++i)
+            {
+                std::uniform_int_distribution<int> pick(i, static_cast<int>(order.size()) - 1);
+                std::swap(order[i], order[pick(rng)]);
+            }
+            order.resize(config.sampleSize);
+            std::sort(order.begin(), order.end());
+            node.sample = std::move(order);
+        }
+        const FeedbackMatrix *matrix = config.feedbackMatrix;
+
+        // Matrix rows of the targets, only usable if every target is in the lexicon
+        if (matrix != nullptr)
+        {
+            for (const auto &target : possibleWords)
+            {
+                int row = matrix->lexicon.row(target);
+                if (row < 0)
+                {
+                    node.targetRows.clear();
+                    break;
+                }
+                node.targetRows.push_back(row);
+            }
+        }
+
+        if (node.targetRows.empty())
+            node.targets = TargetBlock(possibleWords);
+
+        // Create a set for fast O(1) lookups.
+        for (const auto &w : possibleWords)
+        {
+            node.possibleWordSet.insert(w.wordString);
+        }
+
+        // Calculate entropy for each potential guess. Only the top level is split across threads,
+        // each worker writes its guesses in place so the result does not depend on scheduling.
+        std::vector<WordGuess> guesses(fiveLetterWords.size());
+        int numThreads = (recursionLevel == 0) ? ThreadUtils::resolveThreadCount(config.numThreads) : 1;
+        std::optional<ThreadUtils::ThreadPool> pool;
+        if (numThreads > 1 && fiveLetterWords.size() > 1)
+            pool.emplace(numThreads);
+        std::vector<ScoringScratch> scratch(pool ? pool->size() : 1);
+
+        auto forEachGuess = [&](size_t count, size_t chunkSize, const std::function<void(ScoringScratch &, size_t)> &body)
+        {
+            if (pool)
+            {
+                pool->parallelFor(count, chunkSize, [&](int worker, size_t begin, size_t end)
+                                  {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        body(scratch[worker], i);
+                    } });
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    body(scratch[0], i);
+                }
+            }
+        };
+
+        // Guesses that split the candidates into the same buckets get the same score at every level, late
+        // in a game often hundreds of them. When levels past the first are searched, only one guess of each
+        // class is scored and the others copy it; matching hashes are confirmed by comparing partitions.
+        // Not in hard mode, where a child's allowed guesses depend on the guess word and not only its buckets.
+        std::vector<int> representative(fiveLetterWords.size());
+        std::iota(representative.begin(), representative.end(), 0);
+        std::vector<size_t> classSize(fiveLetterWords.size(), 1);
+        if (config.maxDepth > 1 && node.hardModeRule == nullptr)
+        {
+            std::vector<uint64_t> hashes(fiveLetterWords.size());
+            forEachGuess(fiveLetterWords.size(), 64, [&](ScoringScratch &s, size_t i)
+                         { hashes[i] = partitionSignature(node, fiveLetterWords[i], s.signature); });
+
+            std::unordered_map<uint64_t, std::vector<int>> classes;
+            std::vector<uint8_t> signature;
+            std::vector<uint8_t> &other = scratch[0].signature;
+            for (size_t i = 0; i < fiveLetterWords.size(); ++i)
+            {
+                std::vector<int> &members = classes[hashes[i]];
+                if (!members.empty())
+                    partitionSignature(node, fiveLetterWords[i], signature);
+                for (int r : members)
+                {
+                    partitionSignature(node, fiveLetterWords[r], other);
+                    if (signature == other)
+                    {
+                        representative[i] = r;
+                        classSize[r]++;
+                        break;
+                    }
+                }
+                if (representative[i] == static_cast<int>(i))
+                    members.push_back(static_cast<int>(i));
+            }
+        }
+
+        // When pruning, every guess is first scored to depth 1 only. A child search just needs its
+        // single best guess, the top level keeps pruneTopN guesses exact. An anytime search scores depth 1
+        // in full before deepening, and a child search out of time gives up since its result is dropped.
+        ThreadUtils::Deadline *deadline = config.deadline;
+        bool anytime = recursionLevel == 0 && deadline != nullptr && config.maxDepth > 1;
+        bool prune = config.pruneTopN > 0 && config.maxDepth > 1;
+        bool firstLevelOnly = prune || anytime;
+        size_t keepBest = (recursionLevel > 0) ? 1 : (prune ? static_cast<size_t>(config.pruneTopN) : guesses.size());
+        std::vector<std::vector<double>> upperBounds(firstLevelOnly ? fiveLetterWords.size() : 0);
+        bool outOfTime = false;
+
+        forEachGuess(fiveLetterWords.size(), 16, [&](ScoringScratch &s, size_t i)
+                     {
+            if (recursionLevel > 0 && deadline != nullptr && (i & 255) == 0 && deadline->expired())
+                outOfTime = true;
+            if (outOfTime || representative[i] != static_cast<int>(i))
+                return;
+            guesses[i] = firstLevelOnly ? scoreGuess(node, fiveLetterWords[i], s, 1, &upperBounds[i])
+                                        : scoreGuess(node, fiveLetterWords[i], s, config.maxDepth); });
+        if (recursionLevel > 0 && deadline != nullptr && deadline->expired())
+            return {};
+
+        // Deepen the ranking to depth: expand guesses in order of their current rank so the bar to beat
+        // rises quickly, and when pruning skip any guess whose bounds can't rank it ahead of the last of
+        // the best expanded so far. Only the best expansions covering keepBest guesses, a class counting
+        // once per member, replace the current scores, so the ranking doesn't depend on the order threads
+        // finished in. Returns false if the deadline cut it short.
+        auto deepen = [&](int depth)
+        {
+            std::vector<int> order;
+            for (size_t i = 0; i < guesses.size(); ++i)
+            {
+                if (representative[i] == static_cast<int>(i))
+                    order.push_back(static_cast<int>(i));
+            }
+            std::sort(order.begin(), order.end(), [&](int a, int b)
+                      { return guesses[a] < guesses[b]; });
+
+            std::vector<WordGuess> expanded(guesses.size());
+            std::vector<int> best; // Indices of the best expanded guesses, ranked
+            size_t bestCount = 0;  // Guesses covered by best, counting every member of each class
+            std::mutex bestMutex;
+            bool finished = true;
+            forEachGuess(order.size(), 1, [&](ScoringScratch &s, size_t k)
+                         {
+                int i = order[k];
+                {
+                    std::lock_guard<std::mutex> lock(bestMutex);
+                    if (!finished)
+                        return;
+                    if (prune && bestCount >= keepBest &&
+                        !canRankAhead(upperBounds[i], depth, guesses[i], expanded[best.back()]))
+                        return;
+                }
+
+                WordGuess deeper = scoreGuess(node, fiveLetterWords[i], s, depth);
+
+                std::lock_guard<std::mutex> lock(bestMutex);
+                if (deadline != nullptr && deadline->expired())
+                {
+                    finished = false;
+                    return;
+                }
+                expanded[i] = std::move(deeper);
+                auto pos = std::upper_bound(best.begin(), best.end(), i, [&](int a, int b)
+                                            { return expanded[a] < expanded[b]; });
+                best.insert(pos, i);
+                bestCount += classSize[i];
+                while (bestCount - classSize[best.back()] >= keepBest)
+                {
+                    bestCount -= classSize[best.back()];
+                    best.pop_back();
+                } });
+
+            for (int i : best)
+            {
+                guesses[i] = std::move(expanded[i]);
+            }
+            return finished;
+        };
+
+        if (firstLevelOnly)
+        {
+            for (int depth = anytime ? 2 : config.maxDepth; depth <= config.maxDepth; ++depth)
+            {
+                if (!deepen(depth))
+                    break;
+            }
+        }
+        if (recursionLevel > 0 && deadline != nullptr && deadline->expired())
+            return {};
+
+        // The rest of each class take their representative's scores, only the probability is their own
+        for (size_t i = 0; i < guesses.size(); ++i)
+        {
+            if (representative[i] == static_cast<int>(i))
+                continue;
+            guesses[i] = guesses[representative[i]];
+            guesses[i].wordIndex = fiveLetterWords[i].index;
+            bool isPossible = node.possibleWordSet.count(fiveLetterWords[i].wordString);
+            guesses[i].probability = isPossible ? (1.0 / possibleWords.size()) : 0.0;
+        }
+
+        // For recursive calls, only the best guess is needed
+        if (recursionLevel > 0)
+        {
+            if (guesses.empty())
+                return {};
+            WordGuess bestGuess = *std::min_element(guesses.begin(), guesses.end());
+            if (cache != nullptr)
+                cache->insert(fingerprint, config.maxDepth, bestGuess);
+            return {bestGuess};
+        }
+
+        // Sort by entropy levels (highest depth first), then probability and word. With topK only the best
+        // are selected, the rest of the ranking is never needed.
+        size_t keep = (config.topK > 0) ? std::min(guesses.size(), static_cast<size_t>(config.topK)) : guesses.size();
+        std::partial_sort(guesses.begin(), guesses.begin() + keep, guesses.end());
+        guesses.resize(keep);
+
+        return guesses;
+    }
+
+    template <int Length>
+    std::vector<WordGuess> calculateBestGuessesN(
+        const std::vector<WordUtils::Word> &guessWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const Config &config,
+        int recursionLevel)
+    {
+        const int numCodes = numFeedbackCodes(Length);
+        int depth = std::min(config.maxDepth, MAX_SEARCH_DEPTH);
+        double n = static_cast<double>(possibleWords.size());
+
+        // Child searches are cached by candidate set, many guesses leave the same bucket
+        CacheUtils::TranspositionCache<WordGuess> localCache(config.cacheSize);
+        CacheUtils::TranspositionCache<WordGuess> *cache = config.cache;
+        if (cache == nullptr && recursionLevel == 0 && depth > 1 && config.cacheSize > 0)
+            cache = &localCache;
+        uint64_t fingerprint = 0;
+        if (recursionLevel > 0 && cache != nullptr)
+        {
+            std::vector<int> ids;
+            for (const auto &w : possibleWords)
+            {
+                ids.push_back(w.index);
+            }
+            fingerprint = CacheUtils::fingerprint(ids);
+            if (config.hardModeRule != nullptr)
+                fingerprint ^= config.hardModeRule->hash() * 0x9E3779B97F4A7C15ULL;
+            WordGuess cached;
+            if (cache->find(fingerprint, depth, cached))
+                return {cached};
+        }
+
+        // In hard mode only the guesses the rule allows are scored
+        std::vector<WordUtils::Word> allowedWords;
+        if (config.hardModeRule != nullptr)
+            allowedWords = hardModeGuesses(guessWords, *config.hardModeRule);
+        const std::vector<WordUtils::Word> &allWords = (config.hardModeRule != nullptr) ? allowedWords : guessWords;
+
+        // No guess learns more than log2 n at any level. A child search only needs its best levels, so if
+        // one of its own words tells every target apart, that word is the answer without scanning the rest.
+        if (recursionLevel > 0)
+        {
+            std::vector<uint16_t> codes(possibleWords.size());
+            for (const auto &word : possibleWords)
+            {
+                for (size_t t = 0; t < possibleWords.size(); ++t)
+                {
+                    codes[t] = generateFeedbackCodeN<Length>(possibleWords[t], word.wordString);
+                }
+                std::sort(codes.begin(), codes.end());
+                if (std::adjacent_find(codes.begin(), codes.end()) != codes.end())
+                    continue;
+
+                WordGuess guess;
+                guess.wordIndex = word.index;
+                guess.entropy = std::log2(n);
+                guess.entropyList.resize(depth, guess.entropy);
+                guess.scoredDepth = depth;
+                guess.probability = 1.0 / n;
+                return {guess};
+            }
+        }
+
+        std::unordered_set<std::string> possibleWordSet;
+        for (const auto &w : possibleWords)
+        {
+            possibleWordSet.insert(w.wordString);
+        }
+
+        // Per-worker buffers, codes are only partitioned when a deeper level searches the buckets
+        struct Scratch
+        {
+            std::vector<int> counts;
+            std::vector<int> bucketStart;
+            std::vector<uint16_t> codes;
+            std::vector<uint16_t> usedCodes;
+            std::vector<int> partition;
+        };
+
+        std::vector<WordGuess> guesses(allWords.size());
+        auto score = [&](Scratch &s, size_t g)
+        {
+            const WordUtils::Word &word = allWords[g];
+            s.counts.resize(numCodes, 0);
+            s.bucketStart.resize(numCodes, 0);
+            s.codes.resize(possibleWords.size());
+            s.usedCodes.clear();
+            for (size_t t = 0; t < possibleWords.size(); ++t)
+            {
+                uint16_t code = generateFeedbackCodeN<Length>(possibleWords[t], word.wordString);
+                s.codes[t] = code;
+                if (s.counts[code]++ == 0)
+                    s.usedCodes.push_back(code);
+            }
+            std::sort(s.usedCodes.begin(), s.usedCodes.end());
+
+            if (depth > 1)
+            {
+                int start = 0;
+                for (uint16_t code : s.usedCodes)
+                {
+                    s.bucketStart[code] = start;
+                    start += s.counts[code];
+                }
+                s.partition.resize(possibleWords.size());
+                for (size_t t = 0; t < possibleWords.size(); ++t)
+                {
+                    s.partition[s.bucketStart[s.codes[t]]++] = static_cast<int>(t);
+                }
+                for (uint16_t code : s.usedCodes)
+                {
+                    s.bucketStart[code] -= s.counts[code];
+                }
+            }
+
+            WordGuess guess;
+            guess.wordIndex = word.index;
+            Levels entropyList;
+            entropyList.resize(depth, 0.0);
+            for (uint16_t code : s.usedCodes)
+            {
+                int count = s.counts[code];
+                double probability = count / n;
+                double info = bits(probability);
+                entropyList[0] += probability * info;
+
+                // A lone target needs no further search, its deeper levels add nothing
+                Levels childLevels;
+                if (depth > 1 && count > 1)
+                {
+                    std::vector<WordUtils::Word> bucket;
+                    bucket.reserve(count);
+                    for (int k = s.bucketStart[code]; k < s.bucketStart[code] + count; ++k)
+                    {
+                        bucket.push_back(possibleWords[s.partition[k]]);
+                    }
+                    Config nextConfig = config;
+                    nextConfig.maxDepth = depth - 1;
+                    nextConfig.cache = cache;
+                    HardModeRule childRule;
+                    if (config.hardModeRule != nullptr)
+                    {
+                        childRule = *config.hardModeRule;
+                        childRule.add(decodeFeedback(word.wordString, code));
+                        nextConfig.hardModeRule = &childRule;
+                    }
+                    std::vector<WordGuess> next = calculateBestGuessesN<Length>(allWords, bucket, nextConfig, recursionLevel + 1);
+                    if (!next.empty())
+                        childLevels = next[0].entropyList;
+                }
+                for (int i = 0; i + 1 < depth; i++)
+                {
+                    double childEntropy = (i < static_cast<int>(childLevels.size())) ? childLevels[i] : 0.0;
+                    entropyList[i + 1] += probability * (info + childEntropy);
+                }
+            }
+            for (uint16_t code : s.usedCodes)
+            {
+                s.counts[code] = 0;
+            }
+
+            guess.entropy = entropyList.empty() ? 0.0 : entropyList[0];
+            guess.entropyList = entropyList;
+            guess.scoredDepth = depth;
+            guess.probability = possibleWordSet.count(word.wordString) ? (1.0 / n) : 0.0;
+            guesses[g] = guess;
+        };
+
+        // Only the top level is split across threads, each guess is written in place
+        int numThreads = (recursionLevel == 0) ? ThreadUtils::resolveThreadCount(config.numThreads) : 1;
+        if (numThreads > 1 && allWords.size() > 1)
+        {
+            ThreadUtils::ThreadPool pool(numThreads);
+            std::vector<Scratch> scratch(pool.size());
+            pool.parallelFor(allWords.size(), 64, [&](int worker, size_t begin, size_t end)
+                             {
+                for (size_t g = begin; g < end; ++g)
+                {
+                    score(scratch[worker], g);
+                } });
+        }
+        else
+        {
+            Scratch scratch;
+            for (size_t g = 0; g < allWords.size(); ++g)
+            {
+                score(scratch, g);
+            }
+        }
+
+        if (recursionLevel > 0)
+        {
+            if (guesses.empty())
+                return {};
+            WordGuess bestGuess = *std::min_element(guesses.begin(), guesses.end());
+            if (cache != nullptr)
+                cache->insert(fingerprint, depth, bestGuess);
+            return {bestGuess};
+        }
+
+        size_t keep = (config.topK > 0) ? std::min(guesses.size(), static_cast<size_t>(config.topK)) : guesses.size();
+        std::partial_sort(guesses.begin(), guesses.begin() + keep, guesses.end());
+        guesses.resize(keep);
+        return guesses;
+    }
+
+    template std::vector<WordGuess> calculateBestGuessesN<4>(const std::vector<WordUtils::Word> &, const std::vector<WordUtils::Word> &, const Config &, int);
+    template std::vector<WordGuess> calculateBestGuessesN<5>(const std::vector<WordUtils::Word> &, const std::vector<WordUtils::Word> &, const Config &, int);
+    template std::vector<WordGuess> calculateBestGuessesN<6>(const std::vector<WordUtils::Word> &, const std::vector<WordUtils::Word> &, const Config &, int);
+    template std::vector<WordGuess> calculateBestGuessesN<7>(const std::vector<WordUtils::Word> &, const std::vector<WordUtils::Word> &, const Config &, int);
+    template std::vector<WordGuess> calculateBestGuessesN<8>(const std::vector<WordUtils::Word> &, const std::vector<WordUtils::Word> &, const Config &, int);
+
+    std::vector<WordGuess> calculateBestGuessesN(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const Config &config)
+    {
+        switch (config.wordLength)
+        {
+        case 4:
+            return calculateBestGuessesN<4>(allWords, possibleWords, config);
+        case 5:
+            return calculateBestGuessesN<5>(allWords, possibleWords, config);
+        case 6:
+            return calculateBestGuessesN<6>(allWords, possibleWords, config);
+        case 7:
+            return calculateBestGuessesN<7>(allWords, possibleWords, config);
+        case 8:
+            return calculateBestGuessesN<8>(allWords, possibleWords, config);
+        default:
+            throw std::runtime_error("Unsupported word length " + std::to_string(config.wordLength));
+        }
+    }
+
+    std::vector<WordUtils::Word> runWordleSolver(
+        const std::vector<WordUtils::Word> &words,
+        const std::vector<Feedback> &feedbacks)
+    {
+        return filterWords(words, feedbacks);
+    }
+
+    std::vector<WordUtils::Word> availableWordsFor(const std::vector<WordUtils::Word> &allWords, const Config &config)
+    {
+        std::vector<WordUtils::Word> availableWords;
+        for (const auto &word : allWords)
+        {
+            bool exclude = config.excludeUncommonWords && (word.order >= 2);
+            if (word.wordString.size() == static_cast<size_t>(config.wordLength) && !exclude)
+                availableWords.push_back(word);
+        }
+        return availableWords;
+    }
+
+    // Config fields that change an opening book's rankings, pruneTopN only matters past depth 1
+    uint64_t openingBookKey(const Config &config)
+    {
+        uint64_t key = (static_cast<uint64_t>(config.maxDepth) << 1) | (config.excludeUncommonWords ? 1 : 0);
+        if (config.maxDepth > 1)
+            key |= static_cast<uint64_t>(std::max(config.pruneTopN, 0)) << 32;
+        return key;
+    }
+
+    const WordUtils::Word &guessWord(const std::vector<WordUtils::Word> &words, const WordGuess &guess)
+    {
+        // The loaded word list is indexed directly, subsets of it are searched
+        size_t i = static_cast<size_t>(guess.wordIndex);
+        if (guess.wordIndex >= 0 && i < words.size() && words[i].index == guess.wordIndex)
+            return words[i];
+        auto it = std::lower_bound(words.begin(), words.end(), guess.wordIndex, [](const WordUtils::Word &w, int index)
+                                   { return w.index < index; });
+        if (it == words.end() || it->index != guess.wordIndex)
+            throw std::runtime_error("Guess refers to a word missing from the word list");
+        return *it;
+    }
+
+    // Rank the guesses once the candidates left by feedbacks are known
+    Result solveCandidates(
+        const std::vector<WordUtils::Word> &availableWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const std::vector<Feedback> &feedbacks,
+        const Config &config)
+    {
+        // The time budget covers the whole solve
+        ThreadUtils::Deadline deadline(config.timeBudgetMs);
+
+        Result result;
+        result.totalPossibleWords = possibleWords.size();
+        result.possibleWords = possibleWords;
+
+        // The first two turns may already be ranked in the opening book
+        const std::vector<WordGuess> *bookGuesses = nullptr;
+        if (config.openingBook != nullptr && openingBookApplies(feedbacks, config) &&
+            config.openingBook->configKey == openingBookKey(config))
+            bookGuesses = config.openingBook->find(feedbacks);
+        size_t keep = (config.topK > 0) ? static_cast<size_t>(config.topK) : std::numeric_limits<size_t>::max();
+        if (bookGuesses != nullptr)
+        {
+            result.sortedGuesses.assign(bookGuesses->begin(), bookGuesses->begin() + std::min(keep, bookGuesses->size()));
+            result.fromOpeningBook = true;
+            return result;
+        }
+
+        if (config.maxDepth == 0)
+        {
+            // The candidates are already in word order, which is how equal guesses rank
+            for (size_t i = 0; i < possibleWords.size() && i < keep; ++i)
+            {
+                WordGuess guess;
+                guess.wordIndex = possibleWords[i].index;
+                guess.entropy = 0.0;
+                guess.probability = 1.0 / possibleWords.size();
+                result.sortedGuesses.push_back(guess);
+            }
+        }
+        else if (config.wordLength != 5)
+        {
+            // Ranked, or the best topK selected, by the N-letter engine
+            HardModeRule rule(feedbacks);
+            Config searchConfig = config;
+            if (config.hardMode && searchConfig.hardModeRule == nullptr)
+                searchConfig.hardModeRule = &rule;
+            result.sortedGuesses = calculateBestGuessesN(availableWords, possibleWords, searchConfig);
+        }
+        else if (config.minimizeGuesses)
+        {
+            // Already in order of expected guesses. In hard mode the first guess must be allowed, later
+            // ones are chosen among the candidates, which always are.
+            const std::vector<WordUtils::Word> &guessWords =
+                config.hardMode ? hardModeGuesses(availableWords, HardModeRule(feedbacks)) : availableWords;
+            result.sortedGuesses = rankByExpectedGuesses(guessWords, possibleWords, config);
+            if (result.sortedGuesses.size() > keep)
+                result.sortedGuesses.resize(keep);
+        }
+        else
+        {
+            // Calculate best guesses with entropy for all 5-letter words
+            CacheUtils::TranspositionCache<WordGuess> cache(config.cacheSize);
+            Config searchConfig = config;
+            if (searchConfig.cache == nullptr && config.cacheSize > 0 && config.maxDepth > 1)
+                searchConfig.cache = &cache;
+            if (searchConfig.deadline == nullptr && config.timeBudgetMs > 0)
+                searchConfig.deadline = &deadline;
+
+            // Ranked, or the best topK selected, by calculateBestGuesses
+            result.sortedGuesses = calculateBestGuesses(availableWords, possibleWords, feedbacks, searchConfig);
+
+            if (searchConfig.cache != nullptr)
+            {
+                result.cacheHits = searchConfig.cache->getHits();
+                result.cacheMisses = searchConfig.cache->getMisses();
+            }
+        }
+
+        return result;
+    }
+
+    // Enhanced solver that returns best guesses ranked by entropy and possible word count
+    Result runWordleSolverWithEntropy(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<Feedback> &feedbacks,
+        const Config &config)
+    {
+        // Filter words to only 5-letter words, then to those consistent with the feedback
+        std::vector<WordUtils::Word> availableWords = availableWordsFor(allWords, config);
+        std::vector<WordUtils::Word> possibleWords = filterWords(availableWords, feedbacks, config.feedbackMatrix);
+        return solveCandidates(availableWords, possibleWords, feedbacks, config);
+    }
+
+    // --- Interactive session ---
+    Session::Session(const std::vector<WordUtils::Word> &allWords, const Config &config)
+        : config(config), cache(config.cacheSize)
+    {
+        availableWords = availableWordsFor(allWords, config);
+        possibleWords = availableWords;
+    }
+
+    void Session::addFeedback(const Feedback &fb)
+    {
+        // The new feedback only has to be checked against the words the earlier ones left
+        possibleWords = filterWords(possibleWords, {fb}, config.feedbackMatrix);
+        feedbacks.push_back(fb);
+        solvedDepth = -1;
+    }
+
+    void Session::clear()
+    {
+        possibleWords = availableWords;
+        feedbacks.clear();
+        solvedDepth = -1;
+    }
+
+    const Result &Session::solve(int maxDepth, const OpeningBook *openingBook)
+    {
+        if (maxDepth == solvedDepth && openingBook == solvedBook)
+            return lastResult;
+
+        // Child searches depend only on their candidates, so the cache stays valid for the whole game
+        Config searchConfig = config;
+        searchConfig.maxDepth = maxDepth;
+        searchConfig.openingBook = openingBook;
+        if (searchConfig.cache == nullptr && config.cacheSize > 0)
+            searchConfig.cache = &cache;
+
+        long long hits = cache.getHits();
+        long long misses = cache.getMisses();
+        lastResult = solveCandidates(availableWords, possibleWords, feedbacks, searchConfig);
+        if (searchConfig.cache == &cache)
+        {
+            lastResult.cacheHits = cache.getHits() - hits;
+            lastResult.cacheMisses = cache.getMisses() - misses;
+        }
+        solvedDepth = maxDepth;
+        solvedBook = openingBook;
+        return lastResult;
+    }
+
+    MultiBoardResult runMultiBoardSolver(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<std::vector<Feedback>> &boardFeedbacks,
+        const Config &config)
+    {
+        std::vector<WordUtils::Word> availableWords = availableWordsFor(allWords, config);
+        const int solvedCode = numFeedbackCodes(config.wordLength) - 1;
+
+        // Filter every board, a board whose word was already guessed drops out of the scoring
+        MultiBoardResult result;
+        std::vector<int> activeBoards;
+        for (size_t b = 0; b < boardFeedbacks.size(); ++b)
+        {
+            result.possibleWords.push_back(filterWords(availableWords, boardFeedbacks[b], config.feedbackMatrix));
+            bool solved = std::any_of(boardFeedbacks[b].begin(), boardFeedbacks[b].end(), [solvedCode](const Feedback &fb)
+                                      { return encodeFeedbackN(fb) == solvedCode; });
+            result.solved.push_back(solved);
+            if (!solved && !result.possibleWords[b].empty())
+                activeBoards.push_back(static_cast<int>(b));
+        }
+        if (activeBoards.empty() || config.maxDepth == 0)
+            return result;
+
+        // In hard mode a guess must use the hints of every board
+        if (config.hardMode)
+        {
+            HardModeRule rule;
+            for (const auto &feedbacks : boardFeedbacks)
+            {
+                for (const auto &fb : feedbacks)
+                {
+                    rule.add(fb);
+                }
+            }
+            availableWords = hardModeGuesses(availableWords, rule);
+        }
+
+        // Every board reads the same matrix, a board only needs the rows of its own candidates
+        const FeedbackMatrix *matrix = (config.wordLength == 5) ? config.feedbackMatrix : nullptr;
+        std::vector<std::vector<int>> targetRows(boardFeedbacks.size());
+        std::vector<std::unordered_set<std::string>> candidateSets(boardFeedbacks.size());
+        for (int b : activeBoards)
+        {
+            for (const auto &target : result.possibleWords[b])
+            {
+                candidateSets[b].insert(target.wordString);
+            }
+        }
+        for (int b : activeBoards)
+        {
+            for (size_t t = 0; t < result.possibleWords[b].size() && matrix != nullptr; ++t)
+            {
+                int row = matrix->lexicon.row(result.possibleWords[b][t]);
+                if (row < 0)
+                {
+                    matrix = nullptr;
+                    break;
+                }
+                targetRows[b].push_back(row);
+            }
+        }
+
+        // Per-worker buffers
+        struct Scratch
+        {
+            std::vector<int> counts;
+            std::vector<int> usedCodes;
+        };
+
+        std::vector<WordGuess> guesses(availableWords.size());
+        auto score = [&](Scratch &s, size_t g)
+        {
+            const WordUtils::Word &word = availableWords[g];
+            int guessRow = matrix ? matrix->lexicon.row(word) : -1;
+            const uint8_t *guessCodes = (guessRow >= 0) ? matrix->row(guessRow) : nullptr;
+            s.counts.resize(solvedCode + 1, 0);
+
+            WordGuess guess;
+            guess.wordIndex = word.index;
+            for (int b : activeBoards)
+            {
+                const std::vector<WordUtils::Word> &targets = result.possibleWords[b];
+                s.usedCodes.clear();
+                for (size_t t = 0; t < targets.size(); ++t)
+                {
+                    int code = guessCodes ? guessCodes[targetRows[b][t]] : generateFeedbackCodeN(targets[t], word.wordString);
+                    if (s.counts[code]++ == 0)
+                        s.usedCodes.push_back(code);
+                }
+                for (int code : s.usedCodes)
+                {
+                    double probability = static_cast<double>(s.counts[code]) / targets.size();
+                    guess.entropy += probability * bits(probability);
+                    s.counts[code] = 0;
+                }
+
+                // Expected number of boards this guess solves
+                if (candidateSets[b].count(word.wordString))
+                    guess.probability += 1.0 / targets.size();
+            }
+            guess.entropyList = {guess.entropy};
+            guess.scoredDepth = 1;
+            guesses[g] = guess;
+        };
+
+        int numThreads = ThreadUtils::resolveThreadCount(config.numThreads);
+        if (numThreads > 1 && guesses.size() > 1)
+        {
+            ThreadUtils::ThreadPool pool(numThreads);
+            std::vector<Scratch> scratch(pool.size());
+            pool.parallelFor(guesses.size(), 64, [&](int worker, size_t begin, size_t end)
+                             {
+                for (size_t g = begin; g < end; ++g)
+                {
+                    score(scratch[worker], g);
+                } });
+        }
+        else
+        {
+            Scratch scratch;
+            for (size_t g = 0; g < guesses.size(); ++g)
+            {
+                score(scratch, g);
+            }
+        }
+
+        size_t keep = (config.topK > 0) ? std::min(guesses.size(), static_cast<size_t>(config.topK)) : guesses.size();
+        std::partial_sort(guesses.begin(), guesses.begin() + keep, guesses.end());
+        guesses.resize(keep);
+        result.sortedGuesses = std::move(guesses);
+        return result;
+    }
+
+    const char STRATEGY_TREE_MAGIC[8] = {'W', 'G', 'S', 'T', 'R', 'A', 'T', '1'};
+    const uint8_t ALL_GREEN_CODE = NUM_FEEDBACK_CODES - 1;
+
+    int StrategyTree::find(const std::vector<Feedback> &history) const
+    {
+        if (nodes.empty() || history.size() < rootHistory.size())
+            return -1;
+        for (size_t i = 0; i < rootHistory.size(); ++i)
+        {
+            if (!(history[i] == rootHistory[i]))
+                return -1;
+        }
+
+        int node = 0;
+        for (size_t i = rootHistory.size(); i < history.size(); ++i)
+        {
+            if (history[i].word != guess(node))
+                return -1;
+            uint8_t code = encodeFeedback(history[i]);
+            auto begin = edgeCodes.begin() + nodes[node].firstEdge;
+            auto end = begin + nodes[node].edgeCount;
+            auto it = std::lower_bound(begin, end, code);
+            if (it == end || *it != code)
+                return -1;
+            node = edgeTargets[it - edgeCodes.begin()];
+        }
+        return node;
+    }
+
+    // Only the search depth and the word list change which guess is ranked first
+    uint64_t strategyConfigKey(const Config &config)
+    {
+        return (static_cast<uint64_t>(config.maxDepth) << 1) | (config.excludeUncommonWords ? 1 : 0) |
+               (config.hardMode ? (1ULL << 32) : 0);
+    }
+
+    // Add a node for the candidates left after history: choose its guess and reserve one edge per
+    // feedback that doesn't solve the game. Returns the candidates behind each edge, in edge order.
+    std::map<uint8_t, std::vector<WordUtils::Word>> addStrategyNode(
+        StrategyTree &tree,
+        const std::vector<WordUtils::Word> &availableWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const std::vector<Feedback> &history,
+        const Config &config,
+        bool useThreads)
+    {
+        uint32_t index = static_cast<uint32_t>(tree.nodes.size());
+        tree.nodes.emplace_back();
+        tree.nodes[index].candidates = static_cast<uint32_t>(possibleWords.size());
 
-            // Generate all possible feedback patterns for this guess
-            std::unordered_map<unsigned long, int> feedbackCounts;
+        // Group the candidates by the feedback a guess would give, dropping the solved one
+        auto partition = [&possibleWords](const WordUtils::Word &guess)
+        {
+            std::map<uint8_t, std::vector<WordUtils::Word>> buckets;
             for (const auto &target : possibleWords)
             {
-                Feedback fb = generateFeedback(target, word.wordString);
-                feedbackCounts[fb.colors.to_ulong()]++;
+                uint8_t code = generateFeedbackCode(target, guess.wordString);
+                if (code != ALL_GREEN_CODE)
+                    buckets[code].push_back(target);
             }
+            return buckets;
+        };
 
-            // Calculate first level entropy and prepare for deeper levels
-            for (const auto &pair : feedbackCounts)
+        // Without threads the node is searched like a child search, which returns just the best
+        // guess instead of ranking every word
+        WordUtils::Word guess = possibleWords[0];
+        if (possibleWords.size() > 1)
+            guess = guessWord(availableWords, calculateBestGuesses(availableWords, possibleWords, history, config, useThreads ? 0 : 1)[0]);
+        std::map<uint8_t, std::vector<WordUtils::Word>> buckets = partition(guess);
+
+        // A guess that tells the candidates apart by nothing would never finish, play a candidate instead
+        if (buckets.size() == 1 && buckets.begin()->second.size() == possibleWords.size())
+        {
+            guess = possibleWords[0];
+            buckets = partition(guess);
+        }
+
+        std::copy_n(guess.wordString.begin(), 5, tree.nodes[index].guess.begin());
+        tree.nodes[index].firstEdge = static_cast<uint32_t>(tree.edgeCodes.size());
+        tree.nodes[index].edgeCount = static_cast<uint32_t>(buckets.size());
+        for (const auto &bucket : buckets)
+        {
+            tree.edgeCodes.push_back(bucket.first);
+            tree.edgeTargets.push_back(0);
+        }
+        return buckets;
+    }
+
+    // Build the subtree for the candidates left after history depth first and return its root index
+    uint32_t buildStrategySubtree(
+        StrategyTree &tree,
+        const std::vector<WordUtils::Word> &availableWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        std::vector<Feedback> &history,
+        const Config &config)
+    {
+        uint32_t index = static_cast<uint32_t>(tree.nodes.size());
+        std::map<uint8_t, std::vector<WordUtils::Word>> buckets =
+            addStrategyNode(tree, availableWords, possibleWords, history, config, false);
+
+        std::string guess = tree.guess(index);
+        uint32_t edge = tree.nodes[index].firstEdge;
+        for (const auto &bucket : buckets)
+        {
+            history.push_back(decodeFeedback(guess, bucket.first));
+            uint32_t child = buildStrategySubtree(tree, availableWords, bucket.second, history, config);
+            tree.edgeTargets[edge++] = child;
+            history.pop_back();
+        }
+        return index;
+    }
+
+    StrategyTree buildStrategyTree(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<Feedback> &rootFeedbacks,
+        const Config &config)
+    {
+        StrategyTree tree;
+        tree.rootHistory = rootFeedbacks;
+        tree.configKey = strategyConfigKey(config);
+        tree.corpusChecksum = config.feedbackMatrix ? config.feedbackMatrix->lexicon.checksum : Lexicon(allWords).checksum;
+
+        std::vector<WordUtils::Word> availableWords = availableWordsFor(allWords, config);
+        std::vector<WordUtils::Word> possibleWords = filterWords(availableWords, rootFeedbacks, config.feedbackMatrix);
+        if (possibleWords.empty())
+            return tree;
+
+        // Only the first ranked guess is played, and child searches are shared across the whole tree.
+        // A saved tree is meant to be exact, so its searches never sample.
+        CacheUtils::TranspositionCache<WordGuess> cache(config.cacheSize);
+        Config searchConfig = config;
+        searchConfig.pruneTopN = 1;
+        searchConfig.sampleSize = 0;
+        if (searchConfig.cache == nullptr && config.cacheSize > 0 && config.maxDepth > 1)
+            searchConfig.cache = &cache;
+
+        std::map<uint8_t, std::vector<WordUtils::Word>> rootBuckets =
+            addStrategyNode(tree, availableWords, possibleWords, rootFeedbacks, searchConfig, true);
+        std::string rootGuess = tree.guess(0);
+
+        // The subtrees below the root are independent, build them on all threads, largest first
+        std::vector<const std::pair<const uint8_t, std::vector<WordUtils::Word>> *> buckets;
+        for (const auto &bucket : rootBuckets)
+        {
+            buckets.push_back(&bucket);
+        }
+        std::vector<size_t> order(buckets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b)
+                         { return buckets[a]->second.size() > buckets[b]->second.size(); });
+
+        std::vector<StrategyTree> subtrees(buckets.size());
+        ThreadUtils::ThreadPool pool(config.numThreads);
+        pool.parallelFor(order.size(), 1, [&](int, size_t begin, size_t end)
+                         {
+            for (size_t k = begin; k < end; ++k)
             {
-                double probability = static_cast<double>(pair.second) / possibleWords.size();
-                double info = bits(probability);
+                size_t i = order[k];
+                std::vector<Feedback> history = rootFeedbacks;
+                history.push_back(decodeFeedback(rootGuess, buckets[i]->first));
+                buildStrategySubtree(subtrees[i], availableWords, buckets[i]->second, history, searchConfig);
+            } });
 
-                // Can continue if probability is 0, but that shouldn't occur so we can skip the check
+        // Splice the subtrees in edge order, which gives the same layout as a depth-first build
+        for (size_t i = 0; i < subtrees.size(); ++i)
+        {
+            uint32_t nodeOffset = static_cast<uint32_t>(tree.nodes.size());
+            uint32_t edgeOffset = static_cast<uint32_t>(tree.edgeCodes.size());
+            tree.edgeTargets[tree.nodes[0].firstEdge + i] = nodeOffset;
+            for (StrategyTree::Node node : subtrees[i].nodes)
+            {
+                node.firstEdge += edgeOffset;
+                tree.nodes.push_back(node);
+            }
+            tree.edgeCodes.insert(tree.edgeCodes.end(), subtrees[i].edgeCodes.begin(), subtrees[i].edgeCodes.end());
+            for (uint32_t target : subtrees[i].edgeTargets)
+            {
+                tree.edgeTargets.push_back(target + nodeOffset);
+            }
+        }
+        return tree;
+    }
+
+    bool saveStrategyTree(const StrategyTree &tree, const std::string &path)
+    {
+        auto writeU32 = [](std::ofstream &out, uint32_t value)
+        { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
 
-                firstLevelEntropy += probability * info;
+        std::filesystem::path tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary);
+            out.write(STRATEGY_TREE_MAGIC, sizeof(STRATEGY_TREE_MAGIC));
+            out.write(reinterpret_cast<const char *>(&tree.corpusChecksum), sizeof(tree.corpusChecksum));
+            out.write(reinterpret_cast<const char *>(&tree.configKey), sizeof(tree.configKey));
 
-                // Calculate deeper entropy if maxDepth > 1
-                if (config.maxDepth > 1)
-                {
-                    // Create feedback pattern to filter words
-                    Feedback dummyFeedback;
-                    dummyFeedback.word = word.wordString;
-                    dummyFeedback.colors = std::bitset<10>(pair.first);
+            writeU32(out, static_cast<uint32_t>(tree.rootHistory.size()));
+            for (const auto &fb : tree.rootHistory)
+            {
+                out.write(fb.word.data(), 5);
+                uint8_t code = encodeFeedback(fb);
+                out.write(reinterpret_cast<const char *>(&code), 1);
+            }
+
+            writeU32(out, static_cast<uint32_t>(tree.nodes.size()));
+            writeU32(out, static_cast<uint32_t>(tree.edgeCodes.size()));
+            for (const auto &node : tree.nodes)
+            {
+                out.write(node.guess.data(), 5);
+                writeU32(out, node.candidates);
+                writeU32(out, node.firstEdge);
+                writeU32(out, node.edgeCount);
+            }
+            out.write(reinterpret_cast<const char *>(tree.edgeCodes.data()), tree.edgeCodes.size());
+            out.write(reinterpret_cast<const char *>(tree.edgeTargets.data()), tree.edgeTargets.size() * sizeof(uint32_t));
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        return !ec;
+    }
+
+    bool loadStrategyTree(const std::string &path, StrategyTree &tree)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+
+        auto read = [&in](void *data, size_t size)
+        { return static_cast<bool>(in.read(static_cast<char *>(data), size)); };
+        auto readU32 = [&read](uint32_t &value)
+        { return read(&value, sizeof(value)); };
+
+        char magic[sizeof(STRATEGY_TREE_MAGIC)];
+        if (!read(magic, sizeof(magic)) || std::memcmp(magic, STRATEGY_TREE_MAGIC, sizeof(magic)) != 0)
+            return false;
+
+        StrategyTree loaded;
+        uint32_t rootCount = 0;
+        if (!read(&loaded.corpusChecksum, sizeof(loaded.corpusChecksum)) ||
+            !read(&loaded.configKey, sizeof(loaded.configKey)) || !readU32(rootCount))
+            return false;
+        for (uint32_t i = 0; i < rootCount; ++i)
+        {
+            char word[5];
+            uint8_t code = 0;
+            if (!read(word, 5) || !read(&code, 1) || code >= NUM_FEEDBACK_CODES)
+                return false;
+            loaded.rootHistory.push_back(decodeFeedback(std::string(word, 5), code));
+        }
+
+        uint32_t nodeCount = 0;
+        uint32_t edgeCount = 0;
+        if (!readU32(nodeCount) || !readU32(edgeCount))
+            return false;
+        loaded.nodes.resize(nodeCount);
+        for (auto &node : loaded.nodes)
+        {
+            if (!read(node.guess.data(), 5) || !readU32(node.candidates) || !readU32(node.firstEdge) ||
+                !readU32(node.edgeCount) || static_cast<uint64_t>(node.firstEdge) + node.edgeCount > edgeCount)
+                return false;
+        }
+        loaded.edgeCodes.resize(edgeCount);
+        loaded.edgeTargets.resize(edgeCount);
+        if (!read(loaded.edgeCodes.data(), edgeCount) || !read(loaded.edgeTargets.data(), edgeCount * sizeof(uint32_t)))
+            return false;
+        for (uint32_t target : loaded.edgeTargets)
+        {
+            if (target >= nodeCount)
+                return false;
+        }
+
+        tree = std::move(loaded);
+        return true;
+    }
+
+    StrategyTree loadOrBuildStrategyTree(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<Feedback> &rootFeedbacks,
+        const Config &config,
+        const std::string &path)
+    {
+        uint64_t checksum = config.feedbackMatrix ? config.feedbackMatrix->lexicon.checksum : Lexicon(allWords).checksum;
+
+        StrategyTree tree;
+        if (loadStrategyTree(path, tree) && tree.corpusChecksum == checksum &&
+            tree.configKey == strategyConfigKey(config) && tree.rootHistory == rootFeedbacks)
+            return tree;
+
+        std::cerr << "Building Wordle strategy tree...\n";
+        tree = buildStrategyTree(allWords, rootFeedbacks, config);
+        saveStrategyTree(tree, path);
+        return tree;
+    }
+
+    // Total guesses a set of targets takes, summed over the targets. Exact, or a lower bound when the
+    // search gave up on the set as soon as it was clear it couldn't beat the budget it was given.
+    struct ExpectedCost
+    {
+        int total = 0;
+        bool exact = false;
+    };
 
-                    std::vector<Feedback> tempFeedbacks = feedbackHistory;
-                    tempFeedbacks.push_back(dummyFeedback);
-                    std::vector<WordUtils::Word> filteredWords = filterWords(fiveLetterWords, tempFeedbacks);
+    // Branch and bound search behind rankByExpectedGuesses. A set is a list of ascending indices into
+    // targets, and its cost is the sum over its targets of the guesses taken to solve them.
+    struct ExpectedGuessSearch
+    {
+        const std::vector<WordUtils::Word> &guesses;
+        const std::vector<WordUtils::Word> &targets;
+        const Config &config;
+        std::vector<const uint8_t *> guessCodes; // Matrix row of each guess, null if it has none
+        std::vector<int> targetRows;             // Matrix column of each target, empty without a matrix
+        std::vector<int> targetGuess;            // Index in guesses of each target, -1 if it can't be guessed
+        CacheUtils::TranspositionCache<ExpectedCost> memo;
 
-                    if (!filteredWords.empty())
+        ExpectedGuessSearch(const std::vector<WordUtils::Word> &guesses, const std::vector<WordUtils::Word> &targets,
+                            const Config &config)
+            : guesses(guesses), targets(targets), config(config), guessCodes(guesses.size(), nullptr),
+              targetGuess(targets.size(), -1), memo(config.cacheSize)
+        {
+            const FeedbackMatrix *matrix = config.feedbackMatrix;
+            if (matrix != nullptr)
+            {
+                for (const auto &target : targets)
+                {
+                    int row = matrix->lexicon.row(target);
+                    if (row < 0)
                     {
-                        // Recursively calculate best guess for deeper levels
-                        Config nextConfig = config;
-                        nextConfig.maxDepth = config.maxDepth - 1;
-
-                        std::vector<WordGuess> nextBestGuesses = calculateBestGuesses(
-                            fiveLetterWords, filteredWords, tempFeedbacks, nextConfig, recursionLevel + 1);
-
-                        if (!nextBestGuesses.empty())
-                        {
-                            const WordGuess &bestNextGuess = nextBestGuesses[0];
-                            for (int i = 0; i < config.maxDepth - 1 && i < bestNextGuess.entropyList.size(); i++)
-                            {
-                                double additionalEntropy = -bits(possibleWords.size()) +
-                                                           (bits(filteredWords.size()) + bestNextGuess.entropyList[i]);
-                                entropyList[i + 1] += probability * additionalEntropy;
-                            }
-                        }
+                        targetRows.clear();
+                        break;
                     }
+                    targetRows.push_back(row);
                 }
             }
+            std::unordered_map<std::string, int> guessIndex;
+            for (size_t g = 0; g < guesses.size(); ++g)
+            {
+                guessIndex.emplace(guesses[g].wordString, static_cast<int>(g));
+                int row = targetRows.empty() ? -1 : matrix->lexicon.row(guesses[g]);
+                if (row >= 0)
+                    guessCodes[g] = matrix->row(row);
+            }
+            for (size_t t = 0; t < targets.size(); ++t)
+            {
+                auto it = guessIndex.find(targets[t].wordString);
+                if (it != guessIndex.end())
+                    targetGuess[t] = it->second;
+            }
+        }
 
-            entropyList[0] = firstLevelEntropy;
-            guess.entropy = firstLevelEntropy;
-            guess.entropyList = entropyList;
+        uint8_t code(int g, int t) const
+        {
+            if (guessCodes[g] != nullptr)
+                return guessCodes[g][targetRows[t]];
+            return generateFeedbackCode(targets[t], guesses[g].wordString);
+        }
+
+        // Fewest total guesses n targets can take: one solved by the first guess, at most one per
+        // other feedback by the second, and the rest need at least three
+        static int lowerBound(int n)
+        {
+            return 2 * n - 1 + std::max(n - NUM_FEEDBACK_CODES, 0);
+        }
+
+        // Sum of the squared bucket sizes a guess leaves, the winning bucket left out, so smaller is
+        // better; -1 if the guess can't tell any target apart and would leave the whole set
+        int bucketScore(int g, const std::vector<int> &set, std::array<int, NUM_FEEDBACK_CODES> &counts,
+                        std::vector<uint8_t> &used) const
+        {
+            used.clear();
+            for (int t : set)
+            {
+                uint8_t c = code(g, t);
+                if (counts[c]++ == 0)
+                    used.push_back(c);
+            }
+            int score = 0;
+            bool split = used.size() > 1 || used[0] == ALL_GREEN_CODE;
+            for (uint8_t c : used)
+            {
+                if (c != ALL_GREEN_CODE)
+                    score += counts[c] * counts[c];
+                counts[c] = 0;
+            }
+            return split ? score : -1;
+        }
+
+        // The guesses worth trying on a set, best bucketScore first and the set's own words first among
+        // equals, at most config.guessBreadth of them. If stopAtPerfect and some guess leaves only single
+        // targets, returns just that guess: nothing can do better.
+        std::vector<int> shortlist(const std::vector<int> &set, bool stopAtPerfect) const
+        {
+            std::array<int, NUM_FEEDBACK_CODES> counts{};
+            std::vector<uint8_t> used;
+            int n = static_cast<int>(set.size());
+
+            // The set's own words come first, one that splits off every other target is optimal
+            std::vector<bool> inSet(guesses.size(), false);
+            for (int t : set)
+            {
+                if (targetGuess[t] < 0)
+                    continue;
+                inSet[targetGuess[t]] = true;
+                if (stopAtPerfect && bucketScore(targetGuess[t], set, counts, used) == n - 1)
+                    return {targetGuess[t]};
+            }
+
+            std::vector<std::tuple<int, bool, int>> ranked; // score, not in the set, guess
+            for (size_t g = 0; g < guesses.size(); ++g)
+            {
+                // Past the first guess, hard mode only tries the set's own words
+                if (config.hardMode && stopAtPerfect && !inSet[g])
+                    continue;
+                int score = bucketScore(static_cast<int>(g), set, counts, used);
+                if (score < 0)
+                    continue;
+                if (stopAtPerfect && score == n && !inSet[g])
+                    return {static_cast<int>(g)};
+                ranked.emplace_back(score, !inSet[g], static_cast<int>(g));
+            }
+
+            size_t breadth = (config.guessBreadth > 0) ? std::min(ranked.size(), static_cast<size_t>(config.guessBreadth)) : ranked.size();
+            std::partial_sort(ranked.begin(), ranked.begin() + breadth, ranked.end());
+            std::vector<int> chosen;
+            for (size_t i = 0; i < breadth; ++i)
+            {
+                chosen.push_back(std::get<2>(ranked[i]));
+            }
+            return chosen;
+        }
+
+        // Cost of set when g is guessed first, or a lower bound of at least budget if it can't beat it
+        int evaluate(int g, const std::vector<int> &set, int budget)
+        {
+            std::map<uint8_t, std::vector<int>> byCode;
+            for (int t : set)
+            {
+                uint8_t c = code(g, t);
+                if (c != ALL_GREEN_CODE)
+                    byCode[c].push_back(t);
+            }
+
+            // Largest buckets first, they decide whether the budget is exceeded
+            std::vector<std::vector<int>> buckets;
+            for (auto &entry : byCode)
+            {
+                buckets.push_back(std::move(entry.second));
+            }
+            std::stable_sort(buckets.begin(), buckets.end(), [](const std::vector<int> &a, const std::vector<int> &b)
+                             { return a.size() > b.size(); });
+
+            int total = static_cast<int>(set.size());
+            for (const auto &bucket : buckets)
+            {
+                total += lowerBound(static_cast<int>(bucket.size()));
+            }
+            for (const auto &bucket : buckets)
+            {
+                if (total >= budget)
+                    return total;
+                if (bucket.size() <= 2)
+                    break; // The bound is exact from here on
+                int bound = lowerBound(static_cast<int>(bucket.size()));
+                total += solve(bucket, budget - (total - bound)) - bound;
+            }
+            return total;
+        }
+
+        // Cost of set, or a lower bound of at least budget if it can't be solved for less
+        int solve(const std::vector<int> &set, int budget)
+        {
+            int n = static_cast<int>(set.size());
+            int bound = lowerBound(n);
+            if (n <= 2)
+                return bound; // Guess one of the targets
 
-            // Calculate probability of this word being the answer
-            bool isPossible = possibleWordSet.count(word.wordString);
-            guess.probability = isPossible ? (1.0 / possibleWords.size()) : 0.0;
+            uint64_t key = CacheUtils::fingerprint(set);
+            ExpectedCost cached;
+            if (memo.find(key, 0, cached))
+            {
+                if (cached.exact)
+                    return cached.total;
+                bound = std::max(bound, cached.total);
+            }
+            if (bound >= budget)
+                return bound;
+
+            int best = budget;
+            bool found = false;
+            int failedBound = std::numeric_limits<int>::max();
+            for (int g : shortlist(set, true))
+            {
+                int cost = evaluate(g, set, best);
+                if (cost < best)
+                {
+                    best = cost;
+                    found = true;
+                    if (best == bound)
+                        break;
+                }
+                else if (!found)
+                {
+                    failedBound = std::min(failedBound, cost);
+                }
+            }
 
-            guesses.push_back(guess);
+            // Every guess that failed before one succeeded was cut at the same budget, so the smallest of
+            // their bounds is one for the set
+            ExpectedCost result{found ? best : std::max(bound, failedBound), found};
+            memo.insert(key, 0, result);
+            return result.total;
         }
+    };
+
+    std::vector<WordGuess> rankByExpectedGuesses(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const Config &config)
+    {
+        if (possibleWords.empty())
+            return {};
+
+        ExpectedGuessSearch search(allWords, possibleWords, config);
+        std::vector<int> root(possibleWords.size());
+        std::iota(root.begin(), root.end(), 0);
+        std::vector<int> chosen = search.shortlist(root, false);
 
-        // Sort by entropy levels (highest priority first) like mastermind
-        std::sort(guesses.begin(), guesses.end(), [](const WordGuess &a, const WordGuess &b)
-                  {
-            // Compare entropy levels from last to first (highest depth first)
-            for (int i = std::min(a.entropyList.size(), b.entropyList.size()) - 1; i >= 0; i--)
+        // Each top-level guess is searched without a budget so its cost is exact, the memo is shared
+        std::vector<int> totals(chosen.size());
+        int numThreads = ThreadUtils::resolveThreadCount(config.numThreads);
+        auto body = [&](int, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
             {
-                if (a.entropyList[i] != b.entropyList[i])
-                    return a.entropyList[i] > b.entropyList[i];
+                totals[i] = search.evaluate(chosen[i], root, std::numeric_limits<int>::max());
             }
-            // If all entropy levels are equal, prefer higher probability
-            return a.probability > b.probability; });
+        };
+        if (numThreads > 1 && chosen.size() > 1)
+        {
+            ThreadUtils::ThreadPool pool(numThreads);
+            pool.parallelFor(chosen.size(), 1, body);
+        }
+        else
+        {
+            body(0, 0, chosen.size());
+        }
+
+        std::unordered_set<std::string> possibleWordSet;
+        for (const auto &w : possibleWords)
+        {
+            possibleWordSet.insert(w.wordString);
+        }
 
-        // For recursive calls, only return the best guess to save computation
-        if (recursionLevel > 0 && !guesses.empty())
+        std::vector<std::pair<int, WordGuess>> ranked;
+        for (size_t i = 0; i < chosen.size(); ++i)
         {
-            return {guesses[0]};
+            WordGuess guess;
+            guess.wordIndex = allWords[chosen[i]].index;
+            std::map<uint8_t, int> feedbackCounts;
+            for (int t : root)
+            {
+                feedbackCounts[search.code(chosen[i], t)]++;
+            }
+            for (const auto &pair : feedbackCounts)
+            {
+                double probability = static_cast<double>(pair.second) / possibleWords.size();
+                guess.entropy += probability * bits(probability);
+            }
+            guess.entropyList = {guess.entropy};
+            guess.scoredDepth = 1;
+            guess.probability = possibleWordSet.count(allWords[chosen[i]].wordString) ? (1.0 / possibleWords.size()) : 0.0;
+            guess.expectedGuesses = static_cast<double>(totals[i]) / possibleWords.size();
+            ranked.emplace_back(totals[i], guess);
         }
 
+        // Fewest guesses first, then the usual order
+        std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b)
+                  { return a.first != b.first ? a.first < b.first : a.second < b.second; });
+        std::vector<WordGuess> guesses;
+        for (auto &entry : ranked)
+        {
+            guesses.push_back(std::move(entry.second));
+        }
         return guesses;
     }
 
-    std::vector<WordUtils::Word> runWordleSolver(
-        const std::vector<WordUtils::Word> &words,
-        const std::vector<Feedback> &feedbacks)
+    int BenchmarkResult::failures(int limit) const
     {
-        return filterWords(words, feedbacks);
+        int count = unsolved;
+        for (size_t k = limit + 1; k < guessCounts.size(); ++k)
+        {
+            count += guessCounts[k];
+        }
+        return count;
     }
 
-    // Enhanced solver that returns best guesses ranked by entropy and possible word count
-    Result runWordleSolverWithEntropy(
+    double BenchmarkResult::latencyPercentile(double percentile) const
+    {
+        if (positionLatencyMs.empty())
+            return 0.0;
+        std::vector<double> sorted = positionLatencyMs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+        return sorted[std::min(std::max(rank, static_cast<size_t>(1)), sorted.size()) - 1];
+    }
+
+    BenchmarkResult runWordleBenchmark(
         const std::vector<WordUtils::Word> &allWords,
-        const std::vector<Feedback> &feedbacks,
-        const Config &config)
+        const std::vector<WordUtils::Word> &answers,
+        const Config &config,
+        int maxGuesses)
     {
-        // Filter words to only 5-letter words
-        std::vector<WordUtils::Word> availableWords;
-        for (const auto &word : allWords)
+        BenchmarkResult result;
+        result.games = static_cast<int>(answers.size());
+        result.guessCounts.assign(maxGuesses + 1, 0);
+
+        // Guess played at each position, keyed by the history that reached it
+        std::unordered_map<std::string, std::string> chosenGuesses;
+        std::mutex mutex;
+
+        auto historyKey = [](const std::vector<Feedback> &history)
         {
-            bool exclude = config.excludeUncommonWords && (word.order >= 2);
-            if (word.wordString.size() == 5 && !exclude)
-                availableWords.push_back(word);
+            std::string key;
+            for (const auto &fb : history)
+            {
+                key += fb.word;
+                key += std::to_string(encodeFeedbackN(fb));
+                key += ' ';
+            }
+            return key;
+        };
+
+        auto chooseGuess = [&](const std::vector<Feedback> &history, const Config &solveConfig, double *latencyMs)
+        {
+            std::string key = historyKey(history);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = chosenGuesses.find(key);
+                if (it != chosenGuesses.end())
+                    return it->second;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            Result solved = runWordleSolverWithEntropy(allWords, history, solveConfig);
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::string guess = solved.sortedGuesses.empty() ? std::string() : guessWord(allWords, solved.sortedGuesses[0]).wordString;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (chosenGuesses.emplace(key, guess).second)
+            {
+                if (latencyMs != nullptr)
+                    *latencyMs = elapsedMs;
+                else
+                    result.positionLatencyMs.push_back(elapsedMs);
+            }
+            return guess;
+        };
+
+        // Every game opens from the same position, solve it once on all threads before the games start
+        if (!answers.empty())
+            chooseGuess({}, config, &result.openingMs);
+
+        // The games then share the threads, one solver thread each, and only play the top guess
+        Config gameConfig = config;
+        gameConfig.numThreads = 1;
+        gameConfig.topK = 1;
+        std::vector<int> guessesUsed(answers.size(), 0);
+        ThreadUtils::ThreadPool pool(config.numThreads);
+        pool.parallelFor(answers.size(), 1, [&](int, size_t begin, size_t end)
+                         {
+            for (size_t g = begin; g < end; ++g)
+            {
+                std::vector<Feedback> history;
+                for (int turn = 1; turn <= maxGuesses; ++turn)
+                {
+                    std::string guess = chooseGuess(history, gameConfig, nullptr);
+                    if (guess.empty())
+                        break;
+                    if (guess == answers[g].wordString)
+                    {
+                        guessesUsed[g] = turn;
+                        break;
+                    }
+                    history.push_back(generateFeedback(answers[g], guess));
+                }
+            } });
+
+        long long totalGuesses = 0;
+        int solved = 0;
+        for (int used : guessesUsed)
+        {
+            if (used == 0)
+            {
+                result.unsolved++;
+                continue;
+            }
+            result.guessCounts[used]++;
+            totalGuesses += used;
+            solved++;
         }
+        result.meanGuesses = solved ? static_cast<double>(totalGuesses) / solved : 0.0;
+        return result;
+    }
 
-        Result result;
+    bool openingBookApplies(const std::vector<Feedback> &feedbacks, const Config &config)
+    {
+        if (config.maxDepth <= 0 || config.minimizeGuesses || config.wordLength != 5 || feedbacks.size() > 1)
+            return false;
+        if (feedbacks.empty())
+            return true;
 
-        // First filter words based on existing feedback
-        std::vector<WordUtils::Word> possibleWords = filterWords(availableWords, feedbacks);
-        result.totalPossibleWords = possibleWords.size();
+        // Replies keep only their best REPLY_GUESSES, so they only answer a solve asking for no more
+        return !config.hardMode && config.topK > 0 && config.topK <= OpeningBook::REPLY_GUESSES;
+    }
 
-        std::vector<WordGuess> allGuesses;
+    const char OPENING_BOOK_MAGIC[8] = {'W', 'G', 'O', 'P', 'E', 'N', 'B', '1'};
 
-        if (config.maxDepth == 0)
+    const std::vector<WordGuess> *OpeningBook::find(const std::vector<Feedback> &feedbacks) const
+    {
+        if (feedbacks.empty())
+            return opening.empty() ? nullptr : &opening;
+        if (feedbacks.size() == 1)
         {
-            for (const auto &word : possibleWords)
+            auto it = replies.find({feedbacks[0].word, encodeFeedback(feedbacks[0])});
+            if (it != replies.end())
+                return &it->second;
+        }
+        return nullptr;
+    }
+
+    OpeningBook buildOpeningBook(const std::vector<WordUtils::Word> &allWords, const Config &config)
+    {
+        OpeningBook book;
+        book.configKey = openingBookKey(config);
+        book.corpusChecksum = config.feedbackMatrix ? config.feedbackMatrix->lexicon.checksum : Lexicon(allWords).checksum;
+
+        // The book is kept for every later solve, so it is searched exactly and without a time budget
+        Config searchConfig = config;
+        searchConfig.openingBook = nullptr;
+        searchConfig.timeBudgetMs = 0;
+        searchConfig.deadline = nullptr;
+        searchConfig.sampleSize = 0;
+        searchConfig.minimizeGuesses = false;
+        searchConfig.hardMode = false;
+        searchConfig.topK = 0;
+        Result opening = runWordleSolverWithEntropy(allWords, {}, searchConfig);
+        book.opening = opening.sortedGuesses;
+
+        // Only the head of each reply ranking is kept
+        Config replyConfig = searchConfig;
+        replyConfig.topK = OpeningBook::REPLY_GUESSES;
+
+        // Rank the position after every feedback the top openers can get, except the solved one
+        for (int k = 0; k < OpeningBook::OPENERS && k < static_cast<int>(book.opening.size()); ++k)
+        {
+            const std::string &opener = guessWord(allWords, book.opening[k]).wordString;
+            std::set<uint8_t> codes;
+            for (const auto &target : opening.possibleWords)
             {
-                WordGuess guess;
-                guess.word = word;
-                guess.entropy = 0.0;
-                guess.probability = 1.0 / possibleWords.size();
-                allGuesses.push_back(guess);
+                codes.insert(generateFeedbackCode(target, opener));
+            }
+            codes.erase(ALL_GREEN_CODE);
+
+            for (uint8_t code : codes)
+            {
+                Result reply = runWordleSolverWithEntropy(allWords, {decodeFeedback(opener, code)}, replyConfig);
+                book.replies[{opener, code}] = std::move(reply.sortedGuesses);
             }
         }
-        else
+        return book;
+    }
+
+    // Guesses are stored by lexicon row: row, probability, scored depth, then each entropy level
+    void writeBookGuesses(std::ofstream &out, const std::vector<WordGuess> &guesses, const Lexicon &lexicon)
+    {
+        auto writeU32 = [&out](uint32_t value)
+        { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+
+        writeU32(static_cast<uint32_t>(guesses.size()));
+        for (const auto &guess : guesses)
         {
-            // Calculate best guesses with entropy for all 5-letter words
-            allGuesses = calculateBestGuesses(availableWords, possibleWords, feedbacks, config);
+            writeU32(static_cast<uint32_t>(lexicon.row(guess.wordIndex)));
+            out.write(reinterpret_cast<const char *>(&guess.probability), sizeof(guess.probability));
+            writeU32(static_cast<uint32_t>(guess.scoredDepth));
+            writeU32(static_cast<uint32_t>(guess.entropyList.size()));
+            out.write(reinterpret_cast<const char *>(guess.entropyList.data()), guess.entropyList.size() * sizeof(double));
         }
+    }
 
-        std::sort(allGuesses.begin(), allGuesses.end());
+    bool readBookGuesses(std::ifstream &in, std::vector<WordGuess> &guesses, const Lexicon &lexicon)
+    {
+        auto readU32 = [&in](uint32_t &value)
+        { return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value))); };
 
-        result.sortedGuesses = allGuesses;
-        return result;
+        uint32_t count = 0;
+        if (!readU32(count) || count > lexicon.size())
+            return false;
+        guesses.resize(count);
+        for (auto &guess : guesses)
+        {
+            uint32_t row = 0;
+            uint32_t scoredDepth = 0;
+            uint32_t levels = 0;
+            if (!readU32(row) || row >= lexicon.size() ||
+                !in.read(reinterpret_cast<char *>(&guess.probability), sizeof(guess.probability)) ||
+                !readU32(scoredDepth) || !readU32(levels) || levels > MAX_SEARCH_DEPTH)
+                return false;
+            guess.wordIndex = lexicon.words[row].index;
+            guess.scoredDepth = static_cast<int>(scoredDepth);
+            guess.entropyList.resize(levels);
+            if (!in.read(reinterpret_cast<char *>(guess.entropyList.data()), levels * sizeof(double)))
+                return false;
+            guess.entropy = guess.entropyList.empty() ? 0.0 : guess.entropyList[0];
+        }
+        return true;
+    }
+
+    OpeningBook loadOpeningBook(const std::vector<WordUtils::Word> &allWords, const Config &config,
+                                bool buildIfMissing)
+    {
+        Lexicon localLexicon;
+        if (config.feedbackMatrix == nullptr)
+            localLexicon = Lexicon(allWords);
+        const Lexicon &lexicon = config.feedbackMatrix ? config.feedbackMatrix->lexicon : localLexicon;
+        uint64_t configKey = openingBookKey(config);
+
+        std::filesystem::path data_dir = std::filesystem::current_path() / "data";
+        std::string bookName = "wordle_openings_d" + std::to_string(config.maxDepth);
+        if (config.excludeUncommonWords)
+            bookName += "_common";
+        if (config.maxDepth > 1)
+            bookName += "_top" + std::to_string(config.pruneTopN);
+        std::filesystem::path bookPath = data_dir / (bookName + ".bin");
+
+        // Use the saved book if it was built from this corpus and config
+        {
+            std::ifstream in(bookPath, std::ios::binary);
+            char magic[sizeof(OPENING_BOOK_MAGIC)];
+            OpeningBook book;
+            uint32_t replyCount = 0;
+            bool valid = in.read(magic, sizeof(magic)) && std::memcmp(magic, OPENING_BOOK_MAGIC, sizeof(magic)) == 0 &&
+                         in.read(reinterpret_cast<char *>(&book.corpusChecksum), sizeof(book.corpusChecksum)) &&
+                         in.read(reinterpret_cast<char *>(&book.configKey), sizeof(book.configKey)) &&
+                         book.corpusChecksum == lexicon.checksum && book.configKey == configKey &&
+                         readBookGuesses(in, book.opening, lexicon) &&
+                         in.read(reinterpret_cast<char *>(&replyCount), sizeof(replyCount));
+            for (uint32_t i = 0; valid && i < replyCount; ++i)
+            {
+                char word[5];
+                uint8_t code = 0;
+                valid = in.read(word, 5) && in.read(reinterpret_cast<char *>(&code), 1) &&
+                        readBookGuesses(in, book.replies[{std::string(word, 5), code}], lexicon);
+            }
+            if (valid)
+                return book;
+        }
+
+        if (!buildIfMissing)
+            return OpeningBook{};
+
+        std::cerr << "Building Wordle opening book...\n";
+        OpeningBook book = buildOpeningBook(allWords, config);
+
+        std::filesystem::path tempPath = bookPath;
+        tempPath += ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary);
+            out.write(OPENING_BOOK_MAGIC, sizeof(OPENING_BOOK_MAGIC));
+            out.write(reinterpret_cast<const char *>(&book.corpusChecksum), sizeof(book.corpusChecksum));
+            out.write(reinterpret_cast<const char *>(&book.configKey), sizeof(book.configKey));
+            writeBookGuesses(out, book.opening, lexicon);
+            uint32_t replyCount = static_cast<uint32_t>(book.replies.size());
+            out.write(reinterpret_cast<const char *>(&replyCount), sizeof(replyCount));
+            for (const auto &reply : book.replies)
+            {
+                out.write(reply.first.first.data(), 5);
+                out.write(reinterpret_cast<const char *>(&reply.first.second), 1);
+                writeBookGuesses(out, reply.second, lexicon);
+            }
+            if (!out)
+                return book;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, bookPath, ec);
+        return book;
     }
-}
\ No newline at end of file
+}
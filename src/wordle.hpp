@@ -2,23 +2,62 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <initializer_list>
 #include <bitset>
 #include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <map>
 
 #include "utils.hpp"
 
 namespace Wordle
 {
+    class FeedbackMatrix;
+    struct WordGuess;
+    struct OpeningBook;
+    struct HardModeRule;
+
+    const int NUM_FEEDBACK_CODES = 243; // 3^5 color combinations of a 5-letter guess
+    const int MAX_SEARCH_DEPTH = 4;     // Deepest config.maxDepth, the levels of a guess are stored inline
+    const int MIN_WORD_LENGTH = 4;      // Word lengths the N-letter engine is instantiated for
+    const int MAX_WORD_LENGTH = 8;
+
+    // Number of feedback codes of a word length, 3^length
+    constexpr int numFeedbackCodes(int wordLength)
+    {
+        return (wordLength == 0) ? 1 : 3 * numFeedbackCodes(wordLength - 1);
+    }
+
     struct Config
     {
         int maxDepth = 1; // How many moves ahead to calculate entropy
         bool excludeUncommonWords = false;
+        const FeedbackMatrix *feedbackMatrix = nullptr; // Precomputed feedback codes, computed on the fly if null
+        int numThreads = 0;                             // Threads scoring top-level guesses, 0 = one per hardware thread
+        int cacheSize = 100000;                         // Max memoized child searches per solve, 0 disables
+        int pruneTopN = 0;                              // Top-level guesses kept exact past depth 1, 0 disables pruning
+        const OpeningBook *openingBook = nullptr;       // Saved rankings for the first two turns, searched if null
+        int timeBudgetMs = 0;                           // Anytime search deadline per solve, 0 = none
+        int sampleSize = 0;                             // Targets sampled to estimate levels past the first, 0 = exact
+        int sampleAbove = 1000;                         // Nodes with at most this many candidates are always exact
+        int sampleSeed = 1;                             // Seed of the target samples, for reproducible runs
+        bool minimizeGuesses = false;                   // Rank by expected guesses to solve instead of entropy
+        int guessBreadth = 10;                          // Guesses tried per position when minimizing guesses, 0 = all
+        int topK = 0;                                   // Best guesses returned by a solve, 0 = every guess
+        int wordLength = 5;                             // Letters per word, other lengths than 5 use the N-letter engine
+        bool hardMode = false;                          // Every guess must reuse the hints revealed so far
+
+        CacheUtils::TranspositionCache<WordGuess> *cache = nullptr; // Shared by the child searches of one solve
+        ThreadUtils::Deadline *deadline = nullptr;                  // Set from timeBudgetMs for one solve
+        const HardModeRule *hardModeRule = nullptr;                 // Hard mode rule of a child search's path
     };
 
     struct Feedback
     {
-        std::string word;       // 5-letter guess
-        std::bitset<10> colors; // Optimized: bits 0,2,4,6,8 = letter in word, bits 1,3,5,7,9 = correct position
+        std::string word;                        // Guess, usually 5 letters
+        std::bitset<2 * MAX_WORD_LENGTH> colors; // Bit 2i = letter i in word, bit 2i+1 = letter i in position
 
         bool operator==(const Feedback &other) const
         {
@@ -61,12 +100,134 @@ namespace Wordle
         }
     };
 
+    // What hard mode asks of a guess after some feedback: every green letter stays in place and every
+    // letter revealed green or yellow is used at least as often as one guess revealed it
+    struct HardModeRule
+    {
+        std::array<char, MAX_WORD_LENGTH> greens{}; // Letter required at each position, 0 if free
+        std::array<uint8_t, 26> required{};         // Fewest times each letter must be used
+
+        HardModeRule() = default;
+        HardModeRule(const std::vector<Feedback> &feedbacks);
+
+        void add(const Feedback &fb);
+        bool allows(const WordUtils::Word &word) const;
+        uint64_t hash() const; // Equal rules allow the same guesses
+    };
+
+    // Bitsets over a list of 5-letter words answering what a feedback asks about a word: which letter
+    // is at a position and how often a letter occurs. Applying a feedback is a few AND/ANDNOT passes.
+    class CandidateIndex
+    {
+    public:
+        using Bits = std::vector<uint64_t>; // Bit r set = word r
+
+        CandidateIndex() = default;
+        CandidateIndex(const std::vector<WordUtils::Word> &words);
+
+        // Set rows to the words consistent with every feedback.
+        // Returns false if a guess isn't 5 letters a-z, leaving rows unspecified.
+        bool filter(const std::vector<Feedback> &feedbacks, Bits &rows) const;
+
+        static bool test(const Bits &rows, int row) { return (rows[row >> 6] >> (row & 63)) & 1; }
+
+    private:
+        size_t numRows = 0;
+        std::array<std::array<Bits, 26>, 5> atPosition; // [position][letter]
+        std::array<std::array<Bits, 6>, 26> atLeast;    // [letter][k], letter occurs k or more times
+        std::array<std::array<Bits, 6>, 26> exactly;    // [letter][k], letter occurs exactly k times
+    };
+
+    // Dense numbering of every 5-letter word in the corpus, shared by the lookup tables
+    struct Lexicon
+    {
+        std::vector<WordUtils::Word> words;             // Rows in corpus order
+        std::vector<int> rowOfIndex;                    // Word::index -> row, -1 if not a 5-letter word
+        std::unordered_map<std::string, int> rowOfWord; // Word string -> row
+        uint64_t checksum = 0;                          // Identifies the word list the tables were built from
+        CandidateIndex candidates;                      // Feedback filtering over the rows
+
+        Lexicon() = default;
+        Lexicon(const std::vector<WordUtils::Word> &allWords);
+
+        int row(const WordUtils::Word &word) const;
+        int row(int wordIndex) const;
+        int row(const std::string &word) const;
+        size_t size() const { return words.size(); }
+    };
+
+    // Feedback code of every guess against every target in the lexicon, one byte per pair.
+    // Built once, saved next to data/words.bin and memory-mapped on later runs.
+    class FeedbackMatrix
+    {
+    public:
+        Lexicon lexicon;
+
+        const uint8_t *row(int guessRow) const { return data() + static_cast<size_t>(guessRow) * lexicon.size(); }
+        uint8_t code(int guessRow, int targetRow) const { return row(guessRow)[targetRow]; }
+        bool isMapped() const { return file.data() != nullptr; }
+
+        friend FeedbackMatrix loadFeedbackMatrix(const std::vector<WordUtils::Word> &allWords);
+
+    private:
+        FileUtils::MappedFile file;
+        std::vector<uint8_t> buffer; // Used when the cache file could not be written
+        size_t headerSize = 0;
+
+        const uint8_t *data() const { return isMapped() ? file.data() + headerSize : buffer.data(); }
+    };
+
+    // Targets stored position-major, letters[i][t] is letter i of target t, so one guess can be scored
+    // against a block of targets with SIMD compares. Each row is zero-padded to a multiple of 32.
+    struct TargetBlock
+    {
+        std::array<std::vector<uint8_t>, 5> letters;
+        size_t count = 0;
+
+        TargetBlock() = default;
+        TargetBlock(const std::vector<WordUtils::Word> &targets);
+    };
+
+    // One value per search level, stored inline so guesses and cache entries don't allocate
+    struct Levels
+    {
+        std::array<double, MAX_SEARCH_DEPTH> values{};
+        uint8_t count = 0;
+
+        Levels() = default;
+        Levels(std::initializer_list<double> list) { assign(list.begin(), list.end()); }
+
+        template <typename It>
+        void assign(It first, It last)
+        {
+            count = 0;
+            for (; first != last && count < MAX_SEARCH_DEPTH; ++first)
+                values[count++] = *first;
+        }
+        void resize(size_t n, double value = 0.0)
+        {
+            n = std::min(n, static_cast<size_t>(MAX_SEARCH_DEPTH));
+            for (size_t i = count; i < n; ++i)
+                values[i] = value;
+            count = static_cast<uint8_t>(n);
+        }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        double &operator[](size_t i) { return values[i]; }
+        double operator[](size_t i) const { return values[i]; }
+        double *data() { return values.data(); }
+        const double *data() const { return values.data(); }
+    };
+
     struct WordGuess
     {
-        WordUtils::Word word;
+        int wordIndex = -1; // WordUtils::Word::index of the guess, see guessWord
         double entropy = 0.0;
         double probability = 0.0;
-        std::vector<double> entropyList;
+        Levels entropyList;
+        int scoredDepth = 0;          // Levels of entropyList computed exactly, deeper levels are left at 0
+        Levels confidenceList;        // 95% confidence half-width of each level, empty if all are exact
+        double expectedGuesses = 0.0; // Mean guesses to solve, this one included, 0 if not computed
 
         bool operator<(const WordGuess &other) const
         {
@@ -90,18 +251,118 @@ namespace Wordle
             if (std::abs(probability - other.probability) > tolerance)
                 return probability > other.probability; // Sort in descending order (higher probability first)
 
-            // If both entropy and probability are equal, sort by word for consistency
-            return word.wordString < other.word.wordString;
+            // If both entropy and probability are equal, sort by word for consistency. The word list is
+            // loaded in alphabetical order, so its index orders the same way as the word.
+            return wordIndex < other.wordIndex;
         }
     };
 
     struct Result
     {
         std::vector<WordGuess> sortedGuesses;
+        std::vector<WordUtils::Word> possibleWords; // Words consistent with the feedback
         int totalPossibleWords = 0;
+        bool fromOpeningBook = false; // Ranking read from config.openingBook
+        long long cacheHits = 0;
+        long long cacheMisses = 0;
+    };
+
+    // One interactive game. Each feedback narrows the candidates the earlier ones left instead of filtering
+    // the corpus again, child searches stay cached from one solve to the next, and the last ranking is
+    // returned again until the position or the depth changes. Options other than the depth are fixed
+    // by the config the session was made with.
+    class Session
+    {
+    public:
+        Session(const std::vector<WordUtils::Word> &allWords, const Config &config);
+
+        void addFeedback(const Feedback &fb);
+        void clear();
+
+        // Rank the guesses for the current position, answering from openingBook if it covers it
+        const Result &solve(int maxDepth, const OpeningBook *openingBook = nullptr);
+
+        const std::vector<Feedback> &history() const { return feedbacks; }
+        const std::vector<WordUtils::Word> &candidates() const { return possibleWords; } // In word order
+
+    private:
+        Config config;
+        std::vector<WordUtils::Word> availableWords;
+        std::vector<WordUtils::Word> possibleWords;
+        std::vector<Feedback> feedbacks;
+        CacheUtils::TranspositionCache<WordGuess> cache;
+        Result lastResult;
+        int solvedDepth = -1; // Depth of lastResult, -1 if the position changed since
+        const OpeningBook *solvedBook = nullptr;
     };
 
-    // Parse feedback string like "STEAL 01201"
+    // Several boards played with the same guesses, each hiding its own word
+    struct MultiBoardResult
+    {
+        std::vector<WordGuess> sortedGuesses;                    // probability = expected boards solved by the guess
+        std::vector<std::vector<WordUtils::Word>> possibleWords; // Words consistent with each board's feedback
+        std::vector<bool> solved;                                // Boards whose word was already guessed
+    };
+
+    // Complete playbook from one position: the guess to play at every node and, for each feedback
+    // that doesn't solve the game, the node to continue from. Edges of a node are contiguous and
+    // sorted by code, so a history is replayed with one binary search per guess.
+    struct StrategyTree
+    {
+        struct Node
+        {
+            std::array<char, 5> guess{};
+            uint32_t candidates = 0; // Words still possible at this node
+            uint32_t firstEdge = 0;
+            uint32_t edgeCount = 0;
+        };
+
+        std::vector<Node> nodes;           // nodes[0] is the root
+        std::vector<uint8_t> edgeCodes;    // Feedback code of each edge
+        std::vector<uint32_t> edgeTargets; // Child node of each edge
+        std::vector<Feedback> rootHistory; // Feedback already given at the root
+        uint64_t corpusChecksum = 0;       // Lexicon checksum of the word list it was built from
+        uint64_t configKey = 0;            // Config fields that change the chosen guesses
+
+        // Node reached by replaying history, which must start with rootHistory and then follow
+        // the tree's guesses. -1 if the history leaves the tree or solves the game.
+        int find(const std::vector<Feedback> &history) const;
+        std::string guess(int node) const { return std::string(nodes[node].guess.begin(), nodes[node].guess.end()); }
+    };
+
+    // Outcome of playing the solver against a list of answers
+    struct BenchmarkResult
+    {
+        std::vector<int> guessCounts;      // guessCounts[k] = games solved in k guesses
+        int games = 0;
+        int unsolved = 0;                  // Games given up after maxGuesses
+        double meanGuesses = 0.0;          // Over solved games
+        double openingMs = 0.0;                // Solver time of the opening position, on all threads
+        std::vector<double> positionLatencyMs; // Solver time of every later distinct position, on one thread each
+
+        int failures(int limit = 6) const; // Games not solved within limit guesses
+        double latencyPercentile(double percentile) const; // Of positionLatencyMs
+    };
+
+    // Rankings of the opening position and of every reply to the best few openers, for one corpus
+    // and search Config. Saved under data/ so the first two turns need no search. Only the opening
+    // ranks every guess; replies keep their top OpeningBook::REPLY_GUESSES, so they only answer solves with
+    // a topK of at most that.
+    struct OpeningBook
+    {
+        static const int OPENERS = 5;
+        static const int REPLY_GUESSES = 20;
+
+        uint64_t corpusChecksum = 0;
+        uint64_t configKey = 0;
+        std::vector<WordGuess> opening;                                       // No feedback yet
+        std::map<std::pair<std::string, uint8_t>, std::vector<WordGuess>> replies; // (first guess, feedback code) -> ranking
+
+        // Ranking stored for the position after feedbacks, null if the book doesn't cover it
+        const std::vector<WordGuess> *find(const std::vector<Feedback> &feedbacks) const;
+    };
+
+    // Parse feedback string like "STEAL 01201", words of MIN_WORD_LENGTH to MAX_WORD_LENGTH letters
     Feedback parseFeedback(const std::string &input);
 
     // Check if a word matches feedback constraints
@@ -110,6 +371,28 @@ namespace Wordle
     // Generate feedback for a guess against a target word
     Feedback generateFeedback(const WordUtils::Word &target, const std::string &guess);
 
+    // Feedback as a base-3 code: sum of color(i) * 3^i, 0 = all grey, 242 = all green
+    uint8_t generateFeedbackCode(const WordUtils::Word &target, const std::string &guess);
+    uint8_t encodeFeedback(const Feedback &fb);
+
+    // Feedback codes of words of any supported length, numbered like the 5-letter ones. The templates
+    // are instantiated for MIN_WORD_LENGTH to MAX_WORD_LENGTH letters, so each length gets fixed-size loops;
+    // the plain overload picks the instantiation from the guess length.
+    template <int Length>
+    uint16_t generateFeedbackCodeN(const WordUtils::Word &target, const std::string &guess);
+    int generateFeedbackCodeN(const WordUtils::Word &target, const std::string &guess);
+    int encodeFeedbackN(const Feedback &fb);
+
+    // Batched feedback codes of one guess against every target of a block, using AVX2 or SSE2 when
+    // compiled for it. codes must hold targets.count entries; counts is incremented per code.
+    void generateFeedbackCodes(const std::string &guess, const TargetBlock &targets, uint8_t *codes);
+    void countFeedbackCodes(const std::string &guess, const TargetBlock &targets,
+                            std::array<int, NUM_FEEDBACK_CODES> &counts);
+    Feedback decodeFeedback(const std::string &guess, int code);
+
+    // Load the feedback matrix for the corpus from data/, building and saving it if missing or stale
+    FeedbackMatrix loadFeedbackMatrix(const std::vector<WordUtils::Word> &allWords);
+
     // Get all possible feedback patterns for a 5-letter word
     std::vector<Feedback> getAllPossibleFeedbacks();
 
@@ -117,12 +400,27 @@ namespace Wordle
     double calculateEntropy(const std::vector<WordUtils::Word> &possibleWords,
                             const WordUtils::Word &guess);
 
+    // The words hard mode allows as the next guess, in their original order
+    std::vector<WordUtils::Word> hardModeGuesses(const std::vector<WordUtils::Word> &words, const HardModeRule &rule);
+
     // Filter possible words given a list of guesses and feedbacks
     std::vector<WordUtils::Word> filterWords(
         const std::vector<WordUtils::Word> &words,
-        const std::vector<Feedback> &feedbacks);
+        const std::vector<Feedback> &feedbacks,
+        const FeedbackMatrix *feedbackMatrix = nullptr);
 
-    // Calculate best guesses sorted by information value with multi-depth entropy
+    // Calculate best guesses sorted by information value with multi-depth entropy.
+    // possibleWords must already satisfy feedbackHistory; deeper levels search each feedback bucket of it.
+    // With config.pruneTopN > 0 only the first pruneTopN guesses are scored past depth 1, expansions that
+    // provably cannot reach them are skipped and the rest are ranked by their first level only.
+    // With config.deadline the top level scores depth 1 in full, then deepens one level at a time, most
+    // promising guesses first, until the deadline; WordGuess::scoredDepth tells how far each one got.
+    // With config.sampleSize > 0, a node with more than sampleAbove candidates estimates the levels past the
+    // first from a seeded random sample of sampleSize targets, searching only the buckets they fall in.
+    // WordGuess::confidenceList then gives the 95% confidence half-width of each estimated level.
+    // With config.topK > 0 the top level only selects and returns the best topK guesses.
+    // With config.hardMode only guesses allowed after feedbackHistory are scored, and each child search
+    // narrows its parent's guesses by the one feedback that led to it.
     std::vector<WordGuess> calculateBestGuesses(
         const std::vector<WordUtils::Word> &allWords,
         const std::vector<WordUtils::Word> &possibleWords,
@@ -130,10 +428,91 @@ namespace Wordle
         const Config &config = Config{},
         int recursionLevel = 0);
 
+    // Entropy ranking for words of Length letters, like calculateBestGuesses without the feedback matrix,
+    // pruning, time budget or sampling. Only the top level runs on config.numThreads.
+    // Instantiated for MIN_WORD_LENGTH to MAX_WORD_LENGTH letters; the plain overload picks config.wordLength.
+    template <int Length>
+    std::vector<WordGuess> calculateBestGuessesN(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const Config &config,
+        int recursionLevel = 0);
+    std::vector<WordGuess> calculateBestGuessesN(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const Config &config);
+
+    // Rank guesses by the expected number of guesses to solve possibleWords, this one included, when every
+    // later guess minimizes it too. A branch and bound search over candidate subsets: at each position only
+    // the config.guessBreadth guesses leaving the smallest expected bucket are tried, subsets are memoized
+    // with their exact cost or a lower bound, and the top-level guesses are searched in parallel. Only the
+    // guesses tried at the top level are returned, best first.
+    std::vector<WordGuess> rankByExpectedGuesses(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<WordUtils::Word> &possibleWords,
+        const Config &config);
+
+    // The word a guess refers to. words is the loaded word list or any subset of it kept in the same order.
+    const WordUtils::Word &guessWord(const std::vector<WordUtils::Word> &words, const WordGuess &guess);
+
     // Enhanced solver that returns best guesses ranked by entropy and possible word count
     // If config.maxDepth is 0, skips entropy calculation and just returns filtered words
+    // If config.wordLength isn't 5, ranks with calculateBestGuessesN instead
+    // If config.minimizeGuesses, ranks 5-letter words with rankByExpectedGuesses instead
+    // If config.topK > 0, only the best topK guesses are selected and returned
     Result runWordleSolverWithEntropy(
         const std::vector<WordUtils::Word> &allWords,
         const std::vector<Feedback> &feedbacks,
         const Config &config = Config{});
+
+    // Rank guesses for several boards played at once (Quordle, Octordle). boardFeedbacks[b] holds board b's
+    // feedback to every guess so far. A guess scores the sum of its entropies over the unsolved boards, which
+    // for boards hiding independent words is also the entropy of their joint feedback. Solved boards drop out,
+    // every board reads the same feedback matrix and the guesses are scored on config.numThreads.
+    // Only the first level is scored, config.maxDepth 0 just filters the boards.
+    MultiBoardResult runMultiBoardSolver(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<std::vector<Feedback>> &boardFeedbacks,
+        const Config &config = Config{});
+
+    // The config.wordLength-letter words the solver may guess and that may be the answer
+    std::vector<WordUtils::Word> availableWordsFor(const std::vector<WordUtils::Word> &allWords, const Config &config);
+
+    // Play every answer against runWordleSolverWithEntropy, always guessing its top ranked word.
+    // Games run in parallel on config.numThreads; positions shared by several games are solved once.
+    BenchmarkResult runWordleBenchmark(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<WordUtils::Word> &answers,
+        const Config &config,
+        int maxGuesses = 20);
+
+    // Build the opening book for config by searching the opening and the replies to its top openers
+    OpeningBook buildOpeningBook(const std::vector<WordUtils::Word> &allWords, const Config &config);
+
+    // Whether a solve of the position after feedbacks with config would be answered from an opening book:
+    // the opening, or a reply if topK asks for no more than its REPLY_GUESSES. Checked before loading one.
+    bool openingBookApplies(const std::vector<Feedback> &feedbacks, const Config &config);
+
+    // Load the opening book for config from data/ if it matches the corpus. Otherwise build and save it
+    // if buildIfMissing, or return an empty book that covers no position.
+    OpeningBook loadOpeningBook(const std::vector<WordUtils::Word> &allWords, const Config &config,
+                                bool buildIfMissing = true);
+
+    // Build the strategy tree for the position after rootFeedbacks, playing the best ranked guess of
+    // calculateBestGuesses at every node until each candidate is solved
+    StrategyTree buildStrategyTree(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<Feedback> &rootFeedbacks,
+        const Config &config = Config{});
+
+    bool saveStrategyTree(const StrategyTree &tree, const std::string &path);
+    bool loadStrategyTree(const std::string &path, StrategyTree &tree);
+
+    // Load the tree saved at path if it was built from this corpus, config and root history,
+    // otherwise build it and save it there
+    StrategyTree loadOrBuildStrategyTree(
+        const std::vector<WordUtils::Word> &allWords,
+        const std::vector<Feedback> &rootFeedbacks,
+        const Config &config,
+        const std::string &path);
 }
\ No newline at end of file